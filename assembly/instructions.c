@@ -1,7 +1,14 @@
 #include "instructions.h"
 
-int __counter = 0;
+_Thread_local FILE *g_instructions_output = NULL;
+_Thread_local const char *g_label_namespace = MAIN_LABEL_NAMESPACE;
+
+_Thread_local int __counter = 0;
 
 int counter() {
     return __counter++;
-}
\ No newline at end of file
+}
+
+void reset_counter() {
+    __counter = 0;
+}
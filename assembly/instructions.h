@@ -2,14 +2,27 @@
 #define INSTRUCTIONS__H
 
 
+#include <stdio.h>
+
+// Flux où le code est écrit, propre à chaque thread (fixé par write_all_instructions)
+extern _Thread_local FILE *g_instructions_output;
+#define EMIT(...) fprintf(g_instructions_output, __VA_ARGS__)
+
 #define TAG_ALGO_PREFIX "algo__"
+#define TAG_MEMO_PREFIX "memo__"
+
+// Les labels numérotés sont préfixés par l'espace de noms de l'algorithme en
+//   cours d'écriture (TAG_ALGO_PREFIX suivi de son nom), numérotés par son
+//   propre compteur : chaque algorithme peut être écrit dans un thread
+#define MAIN_LABEL_NAMESPACE "main"
+extern _Thread_local const char *g_label_namespace;
 
 // Tag
-#define TAG(tag_name) printf(":%s\n", tag_name);
+#define TAG(tag_name) EMIT(":%s\n", tag_name);
 
 // Utilitaire
-#define TAGC(tag_name, count) printf(":%s__%d\n", tag_name, count);
-#define TAGCN(tag_name, count, buff) sprintf(buff, "%s__%d", tag_name, count)
+#define TAGC(tag_name, count) EMIT(":%s__%s__%d\n", g_label_namespace, tag_name, count);
+#define TAGCN(tag_name, count, buff) sprintf(buff, "%s__%s__%d", g_label_namespace, tag_name, count)
 
 // Registres
 #define R1 "ax"
@@ -20,39 +33,39 @@
 #define RSP "sp"
 
 // Instructions
-#define CF(fmt, ...) printf("; " fmt "\n", __VA_ARGS__);
+#define CF(fmt, ...) EMIT("; " fmt "\n", __VA_ARGS__);
 #define C(str) CF("%s", str);
 
-#define CONSTSTR(reg, val) printf("\tconst %s,%s\n", reg, val);
-#define CONSTINT(reg, val) printf("\tconst %s,%d\n", reg, val);
+#define CONSTSTR(reg, val) EMIT("\tconst %s,%s\n", reg, val);
+#define CONSTINT(reg, val) EMIT("\tconst %s,%d\n", reg, val);
 
-#define PUSH(reg) printf("\tpush %s\n", reg);
-#define POP(reg) printf("\tpop %s\n", reg);
+#define PUSH(reg) EMIT("\tpush %s\n", reg);
+#define POP(reg) EMIT("\tpop %s\n", reg);
 
-#define CP(reg1, reg2) printf("\tcp %s,%s\n", reg1, reg2);
+#define CP(reg1, reg2) EMIT("\tcp %s,%s\n", reg1, reg2);
 
-#define CMP(reg1, reg2) printf("\tcmp %s,%s\n", reg1, reg2);
-#define ULESS(reg1, reg2) printf("\tuless %s,%s\n", reg1, reg2);
-#define SLESS(reg1, reg2) printf("\tsless %s,%s\n", reg1, reg2);
+#define CMP(reg1, reg2) EMIT("\tcmp %s,%s\n", reg1, reg2);
+#define ULESS(reg1, reg2) EMIT("\tuless %s,%s\n", reg1, reg2);
+#define SLESS(reg1, reg2) EMIT("\tsless %s,%s\n", reg1, reg2);
 
-#define JMP(reg) printf("\tjmp %s\n", reg);
-#define JMPE(reg) printf("\tjmpe %s\n", reg);
-#define JMPC(reg) printf("\tjmpc %s\n", reg);
-#define JMPZ(reg) printf("\tjmpz %s\n", reg);
+#define JMP(reg) EMIT("\tjmp %s\n", reg);
+#define JMPE(reg) EMIT("\tjmpe %s\n", reg);
+#define JMPC(reg) EMIT("\tjmpc %s\n", reg);
+#define JMPZ(reg) EMIT("\tjmpz %s\n", reg);
 
-#define LOADW(val_reg, addr_reg) printf("\tloadw %s,%s\n", val_reg, addr_reg);
-#define STOREW(val_reg, addr_reg) printf("\tstorew %s,%s\n", val_reg, addr_reg);
+#define LOADW(val_reg, addr_reg) EMIT("\tloadw %s,%s\n", val_reg, addr_reg);
+#define STOREW(val_reg, addr_reg) EMIT("\tstorew %s,%s\n", val_reg, addr_reg);
 
-#define CALL(reg) printf("\tcall %s\n", reg);
+#define CALL(reg) EMIT("\tcall %s\n", reg);
 
 // Gestion des erreurs
 #define ERRORTAG(tag_name, message)                                            \
     TAG("msg__" tag_name);                                                     \
-    printf("@string \"" message "\\n\"\n");                                    \
+    EMIT("@string \"" message "\\n\"\n");                                    \
     TAG(tag_name);                                                             \
     CONSTSTR(R1, "msg__" tag_name);                                            \
-    printf("\tcallprintfs %s\n", R1);                                          \
-    printf("\tend\n");
+    EMIT("\tcallprintfs %s\n", R1);                                          \
+    EMIT("\tend\n");
 
 #define LOAD_ERROR_ADDR(reg, error_tag) CONSTSTR(reg, error_tag);
 
@@ -67,7 +80,7 @@
     PUSH(tmp_reg);                                                             \
     CP(reg, RBP);                                                              \
     CONSTINT(tmp_reg, (offset) * 2);                                           \
-    printf("\tsub %s,%s\n", reg, tmp_reg);                                     \
+    EMIT("\tsub %s,%s\n", reg, tmp_reg);                                     \
     POP(tmp_reg);
 
 #define LOAD_LOCAL_ADDR(reg, tmp_reg, pos) LOAD_ADDR(reg, tmp_reg, 1 + pos);
@@ -76,70 +89,98 @@
 
 #define LOAD_RETURN_ADDR(reg, tmp_reg, var_count) LOAD_ADDR(reg, tmp_reg, 1 + var_count);
 
+// Mémoïsation : variable locale cachée (nom impossible à écrire en algo) qui
+//   contient l'indice de l'appel courant dans la table
+#define MEMO_INDEX_VAR "memo#index"
+#define MEMO_NO_INDEX -1
+
+// Adresse de l'entrée index_reg (détruit) de la table de l'algorithme dans reg
+#define MEMO_ENTRY_ADDR(reg, index_reg, tmp_reg, alg_name)                     \
+    CONSTINT(tmp_reg, 4);                                                      \
+    EMIT("\tmul %s,%s\n", index_reg, tmp_reg);                               \
+    EMIT("\tconst %s," TAG_MEMO_PREFIX "%s\n", reg, alg_name);               \
+    ADD_R(reg, index_reg);
+
+// Adresse de l'entrée index_reg (détruit) de la table de sauts numéro id de
+//   l'espace de noms label_namespace
+#define JUMP_TABLE_ENTRY_ADDR(reg, index_reg, tmp_reg, label_namespace, id)    \
+    CONSTINT(tmp_reg, 2);                                                      \
+    EMIT("\tmul %s,%s\n", index_reg, tmp_reg);                               \
+    EMIT("\tconst %s,%s__jtable__%d\n", reg, label_namespace, id);           \
+    ADD_R(reg, index_reg);
+
 // Renvoie la valeur au sommet de la pile, contient ret (termine l'appel)
 #define RETURN(var_count)                                                      \
     C("Returning first stack value");                                          \
     LOAD_RETURN_ADDR(R2, R1, var_count);                                       \
     POP(R1); STOREW(R1, R2)                                                    \
-    FUNC_END(); printf("\tret\n");
+    FUNC_END(); EMIT("\tret\n");
 
 // Opérations
-#define ADD_R(reg1, reg2) printf("\tadd %s,%s\n", reg1, reg2);
+#define ADD_R(reg1, reg2) EMIT("\tadd %s,%s\n", reg1, reg2);
 
-#define ADD() C("OP Add"); POP(R2); POP(R1); printf("\tadd %s,%s\n", R1, R2); PUSH(R1);
-#define SUB() C("OP Sub"); POP(R2); POP(R1); printf("\tsub %s,%s\n", R1, R2); PUSH(R1);
-#define MUL() C("OP Mul"); POP(R2); POP(R1); printf("\tmul %s,%s\n", R1, R2); PUSH(R1);
+#define ADD() C("OP Add"); POP(R2); POP(R1); EMIT("\tadd %s,%s\n", R1, R2); PUSH(R1);
+#define SUB() C("OP Sub"); POP(R2); POP(R1); EMIT("\tsub %s,%s\n", R1, R2); PUSH(R1);
+#define MUL() C("OP Mul"); POP(R2); POP(R1); EMIT("\tmul %s,%s\n", R1, R2); PUSH(R1);
 #define DIV() C("OP Div"); POP(R2); POP(R1);                                   \
     LOAD_ERROR_ADDR(R3, ERROR_DIVISION_BY_ZERO);                               \
-    printf("\tdiv %s,%s\n", R1, R2); JMPE(R3);                                 \
+    EMIT("\tdiv %s,%s\n", R1, R2); JMPE(R3);                                 \
     PUSH(R1);
+// Diviseur prouvé non nul par l'analyse d'intervalles
+#define DIV_NO_CHECK() C("OP Div"); POP(R2); POP(R1); EMIT("\tdiv %s,%s\n", R1, R2); PUSH(R1);
 
-#define AND() C("OP And"); POP(R2); POP(R1); printf("\tand %s,%s\n", R1, R2); PUSH(R1);
-#define OR() C("OP Or"); POP(R2); POP(R1); printf("\tor %s,%s\n", R1, R2); PUSH(R1);
+#define AND() C("OP And"); POP(R2); POP(R1); EMIT("\tand %s,%s\n", R1, R2); PUSH(R1);
+#define OR() C("OP Or"); POP(R2); POP(R1); EMIT("\tor %s,%s\n", R1, R2); PUSH(R1);
 
 #define NOT() C("OP Not");                                                     \
     POP(R1); PUSH(R2); CONSTINT(R2, 2)                                         \
-    printf("\tnot %s\n\tadd %s,%s\n", R1, R1, R2);                             \
+    EMIT("\tnot %s\n\tadd %s,%s\n", R1, R1, R2);                             \
     POP(R2); PUSH(R1);
 
 
-#define BOOL_OP(operation)                                                     \
+// Résultat dans R3 : if_true si l'opération positionne la retenue, if_false sinon
+#define BOOL_OP_VALUES(operation, if_true, if_false)                           \
         {                                                                      \
             int op_counter = counter();                                        \
-            printf("\tconst %s,op__true__%d\n", R4, op_counter);               \
-            printf("\t" #operation " %s,%s\n", R1, R2);                        \
+            EMIT("\tconst %s,%s__op__true__%d\n", R4, g_label_namespace, op_counter); \
+            EMIT("\t" #operation " %s,%s\n", R1, R2);                        \
             JMPC(R4);                                                          \
-            CONSTINT(R3, 0);                                                   \
-            printf("\tconst %s,op__end__%d\n", R4, op_counter);                \
+            CONSTINT(R3, if_false);                                            \
+            EMIT("\tconst %s,%s__op__end__%d\n", R4, g_label_namespace, op_counter); \
             JMP(R4);                                                           \
-            printf(":op__true__%d\n", op_counter);                             \
-            CONSTINT(R3, 1);                                                   \
-            printf(":op__end__%d\n", op_counter);                              \
+            EMIT(":%s__op__true__%d\n", g_label_namespace, op_counter);        \
+            CONSTINT(R3, if_true);                                             \
+            EMIT(":%s__op__end__%d\n", g_label_namespace, op_counter);         \
         }
 
+#define BOOL_OP(operation) BOOL_OP_VALUES(operation, 1, 0)
+
 
 #define EQUAL() BOOL_OP(cmp);
+#define NOT_EQUAL() BOOL_OP_VALUES(cmp, 0, 1);
 #define LESS() BOOL_OP(uless);
 
 #define LESS_EQ()                                                              \
         {                                                                      \
             int op_counter = counter();                                        \
             LESS();                                                            \
-            printf("\tconst %s,op__equal__%d\n", R4, op_counter);              \
+            EMIT("\tconst %s,%s__op__equal__%d\n", R4, g_label_namespace, op_counter); \
             CMP(R3, R3);                                                       \
             JMPZ(R4);                                                          \
-            printf("\tconst %s,op__end__%d\n", R4, op_counter);                \
+            EMIT("\tconst %s,%s__op__end__%d\n", R4, g_label_namespace, op_counter); \
             JMP(R4);                                                           \
-            printf(":op__equal__%d\n", op_counter);                            \
+            EMIT(":%s__op__equal__%d\n", g_label_namespace, op_counter);       \
             EQUAL();                                                           \
-            printf(":op__end__%d\n", op_counter);                              \
+            EMIT(":%s__op__end__%d\n", g_label_namespace, op_counter);         \
         }
 
 #define EQUAL_OP() POP(R2); POP(R1); EQUAL(); PUSH(R3);
+#define NOT_EQUAL_OP() POP(R2); POP(R1); NOT_EQUAL(); PUSH(R3);
 #define LESS_OP(reg1, reg2) POP(reg2); POP(reg1); LESS(); PUSH(R3);
 #define LESS_EQ_OP(reg1, reg2) POP(reg2); POP(reg1); LESS_EQ(); PUSH(R3);
 
 extern int counter();
+extern void reset_counter(); // Au début de chaque espace de noms
 
 
 #endif
\ No newline at end of file
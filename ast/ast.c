@@ -1,9 +1,23 @@
+#define _POSIX_C_SOURCE 200809L // open_memstream
+
 #include "ast.h"
 
 #include <stdlib.h>
 #include <stdio.h>
-
-#define MAX_SCOPE_DEPTH 1024
+#include <string.h>
+#include <limits.h>
+#include <setjmp.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "parallel.h"
+
+// L'état des passes (variables g_*) est propre à chaque thread : des
+//   compilations concurrentes, une par thread, ne partagent que la table
+//   des identifiants internés. Celui qu'une passe laisse aux suivantes est
+//   regroupé dans g_passes : les tâches des passes menées algorithme par
+//   algorithme (optimisation, vérification, écriture) le reprennent avec
+//   restore_ast_passes, puis fixent le reste à leur entrée
 
 typedef enum {
     // Expressions
@@ -31,28 +45,55 @@ typedef enum {
     NODE_SPEC_PARAMS_REASSIGN,
 } ast_node_type;
 
+// Table de mémoïsation d'un algorithme : une entrée (drapeau, valeur) par
+//   combinaison des valeurs possibles des paramètres
+typedef struct {
+    int size;
+    int lo[MAX_PARAMS_COUNT];       // Plus petite valeur de chaque paramètre
+    int stride[MAX_PARAMS_COUNT];
+    variable *index;                // Locale MEMO_INDEX_VAR, indice calculé à l'entrée
+} memo_table;
+
+// Indice d'un nœud dans l'annuaire de sa compilation (voir node_at), 0 : aucun
+typedef uint32_t node_id;
+
+// Les expressions, la grande majorité des nœuds, désignent leurs fils par
+//   indice 32 bits ; les instructions gardent des pointeurs. Le variable *
+//   d'un symbole, d'une assignation ou d'un DOFORI est cherché une seule fois
+//   par nom (node_variable). Les DOFORI, rares, sont hors du nœud
+struct do_for_i_payload {
+    const char *var_name;
+    variable *var;
+    node_id start_expr;
+    node_id end_expr;
+    ast_node *body;
+    int end_bounded;
+};
+
 struct ast_node {
     ast_node_type type;
     int line;
+    node_id id;
     union {
         int number_value;
-        char *symbol_name;
-        struct { ast_node *operand; unary_operator_t operator; value_type result_type; } unary_operator;
-        struct { ast_node *left; binary_operator_t operator; ast_node *right; value_type result_type; } binary_operator;
-        struct { char *var_name; ast_node *expr; } assignement;
-        struct { ast_node *expr; } inst_return; // ne peut pas s'appeler "return" car mot clé du langage c
-        struct { char *function_name; ast_node **parameters_expr; int params_count; } call;
-        struct { ast_node *condition; ast_node *then_block; ast_node *else_block; } if_statement;
-        struct { const char *var_name; ast_node *start_expr; ast_node *end_expr; ast_node *body; } do_for_i;
-        struct { ast_node *condition; ast_node *body; } do_while;
-        struct { char *function_name; ast_node *body; } function;
-        struct { ast_node *first; ast_node *second; } sequence;
-        struct { ast_node **parameters_expr; int params_count; } spec_params_reassign;
+        struct { const char *symbol_name; variable *symbol_var; }; // Nom interné
+        struct { node_id operand; unary_operator_t operator; value_type result_type; } unary_operator;
+        struct { node_id left; binary_operator_t operator; node_id right; value_type result_type; int divisor_nonzero; } binary_operator;
+        struct { const char *var_name; variable *var; node_id expr; } assignement;
+        struct { node_id expr; } inst_return; // ne peut pas s'appeler "return" car mot clé du langage c
+        struct { const char *function_name; node_id *parameters_expr; int params_count; } call;
+        struct { node_id condition; ast_node *then_block; ast_node *else_block; } if_statement;
+        struct do_for_i_payload *do_for_i;
+        struct { node_id condition; ast_node *body; } do_while;
+        struct { const char *function_name; ast_node *body; memo_table *memo; } function;
+        struct { ast_node **statements; int count; int capacity; } sequence; // À plat, NULL possibles après réécriture
+        struct { node_id *parameters_expr; int params_count; } spec_params_reassign;
     };
 };
 
 
-static ast_node *make_spec_params_reassign(ast_node **params_expr, int pcount);
+static ast_node *make_spec_params_reassign(node_id *params_expr, int pcount);
+static int wrap_word(long long value);
 
 
 //  ------------------------------------------------------------------------  //
@@ -62,12 +103,175 @@ static ast_node *make_spec_params_reassign(ast_node **params_expr, int pcount);
 //  ------------------------------------------------------------------------  //
 //  ------------------------------------------------------------------------  //
 //  ------------------------------------------------------------------------  //
+static _Thread_local arena *g_ast_arena = NULL;  // Arène des nœuds créés
+static _Thread_local ast_passes_state g_passes;
+
+// Annuaire des nœuds d'une compilation. Les nœuds restent dans l'arène de leur
+//   algorithme, rangés en préordre ; un indice désigne une région de
+//   NODE_REGION_SIZE octets, enregistrée à son premier nœud, et la position
+//   du nœud dans cette région. Les régions ne sont jamais déplacées : un
+//   indice reste valide tant que le nœud est vivant, quel que soit le thread
+#define NODE_OFFSET_BITS 11
+#define NODE_OFFSET_MASK ((1u << NODE_OFFSET_BITS) - 1)
+#define NODE_REGIONS ((size_t) 1 << (32 - NODE_OFFSET_BITS))
+#define NODE_REGION_SIZE (alignof(ast_node) << NODE_OFFSET_BITS)
+
+struct ast_nodes {
+    pthread_mutex_t lock;       // Enregistrement par les threads des tâches
+    uint32_t regions_count;
+    uintptr_t *regions;         // Début de chaque région, NODE_REGIONS entrées
+};
+
+// Régions de l'annuaire de g_passes, et dernière région enregistrée par ce
+//   thread, où vont ses nœuds suivants
+static _Thread_local const uintptr_t *g_node_regions;
+static _Thread_local struct { uintptr_t start; uint32_t region; } g_node_region;
+
+// La région 0 commence à l'adresse 0 : l'indice 0 donne NULL
+static inline ast_node *node_at(node_id id) {
+    return (ast_node *) (g_node_regions[id >> NODE_OFFSET_BITS] + (id & NODE_OFFSET_MASK) * alignof(ast_node));
+}
+
+static inline node_id id_of(const ast_node *node) {
+    return node == NULL ? 0 : node->id;
+}
+
+// La table des régions n'est remplie qu'au fur et à mesure : calloc ne touche
+//   pas les pages qui restent à zéro
+static ast_nodes *create_ast_nodes(void) {
+    ast_nodes *nodes = cralloc(sizeof *nodes);
+    nodes->regions = calloc(NODE_REGIONS, sizeof *nodes->regions);
+    if (nodes->regions == NULL) {
+        free(nodes);
+        ERROR("Could not allocate\n");
+    }
+    pthread_mutex_init(&nodes->lock, NULL);
+    nodes->regions_count = 1;
+    return nodes;
+}
+
+static void dispose_ast_nodes(ast_nodes **nodes) {
+    if (*nodes == NULL) return;
+    free((*nodes)->regions);
+    pthread_mutex_destroy(&(*nodes)->lock);
+    free(*nodes);
+    *nodes = NULL;
+}
+
+static void use_ast_nodes(ast_nodes *nodes) {
+    g_node_regions = nodes != NULL ? nodes->regions : NULL;
+    g_node_region.start = 0;
+}
+
+static node_id register_node(ast_node *node) {
+    // Un nœud avant le début de la région donne un écart hors bornes
+    uintptr_t offset = (uintptr_t) node - g_node_region.start;
+    if (g_node_region.start == 0 || offset > NODE_REGION_SIZE - sizeof(ast_node)) {
+        ast_nodes *nodes = g_passes.nodes;
+        pthread_mutex_lock(&nodes->lock);
+        uint32_t region = nodes->regions_count;
+        if (region == NODE_REGIONS) {
+            pthread_mutex_unlock(&nodes->lock);
+            ERROR("Too many AST nodes\n");
+        }
+        nodes->regions[region] = (uintptr_t) node;
+        nodes->regions_count++;
+        pthread_mutex_unlock(&nodes->lock);
+        g_node_region.start = (uintptr_t) node;
+        g_node_region.region = region;
+        offset = 0;
+    }
+    return (g_node_region.region << NODE_OFFSET_BITS) | (node_id) (offset / alignof(ast_node));
+}
+
+ast_passes_state save_ast_passes(void) {
+    return g_passes;
+}
+
+void restore_ast_passes(const ast_passes_state *state) {
+    g_passes = *state;
+    use_ast_nodes(g_passes.nodes);
+}
+
+arena *set_ast_arena(arena *nodes) {
+    arena *previous = g_ast_arena;
+    g_ast_arena = nodes;
+    return previous;
+}
+
+// L'annuaire est créé au premier nœud de la compilation, par l'analyseur
 static ast_node *cranode() {
-    ast_node *node = (ast_node *) cralloc(sizeof(ast_node));
+    if (g_ast_arena == NULL) { ERROR("No arena to allocate AST nodes\n"); }
+    if (g_passes.nodes == NULL) {
+        g_passes.nodes = create_ast_nodes();
+        use_ast_nodes(g_passes.nodes);
+    }
+    // Sans arrondi à max_align_t, les nœuds se suivent sans trou
+    ast_node *node = arena_alloc_aligned(g_ast_arena, sizeof(ast_node), alignof(ast_node));
     node->line = -1;
+    node->id = register_node(node);
     return node;
 }
 
+// Variable désignée par un symbole, une assignation ou un DOFORI. Le nom n'est
+//   haché qu'au premier usage, les passes suivantes lisent le pointeur gardé.
+static variable *node_variable(ast_node *node, const variables_map *vars) {
+    switch (node->type) {
+        case NODE_SYMBOL:
+            if (node->symbol_var == NULL) {
+                node->symbol_var = get_variable(vars, node->symbol_name);
+            }
+            return node->symbol_var;
+        case NODE_ASSIGNEMENT:
+            if (node->assignement.var == NULL) {
+                node->assignement.var = get_variable(vars, node->assignement.var_name);
+            }
+            return node->assignement.var;
+        case NODE_DO_FOR_I:
+            if (node->do_for_i->var == NULL) {
+                node->do_for_i->var = get_variable(vars, node->do_for_i->var_name);
+            }
+            return node->do_for_i->var;
+        default:
+            ERROR("Node does not name a variable\n");
+    }
+}
+
+static ast_node **alloc_statements(int capacity) {
+    return arena_alloc_aligned(g_ast_arena, (size_t) (capacity > 0 ? capacity : 1) * sizeof(ast_node *), alignof(ast_node *));
+}
+
+// Ajoute ast à la fin d'une séquence : les NULL sont ignorés, les séquences
+//   sont recopiées instruction par instruction pour rester à plat
+static void sequence_append(ast_node *seq, ast_node *ast) {
+    if (ast == NULL) return;
+    if (ast->type == NODE_SEQUENCE) {
+        for (int i = 0; i < ast->sequence.count; ++i) {
+            sequence_append(seq, ast->sequence.statements[i]);
+        }
+        return;
+    }
+    if (seq->sequence.count == seq->sequence.capacity) {
+        // L'ancien tableau reste dans l'arène jusqu'au prochain compactage
+        int capacity = seq->sequence.capacity > 0 ? seq->sequence.capacity * 2 : 4;
+        ast_node **statements = alloc_statements(capacity);
+        if (seq->sequence.count > 0) {
+            memcpy(statements, seq->sequence.statements, (size_t) seq->sequence.count * sizeof *statements);
+        }
+        seq->sequence.statements = statements;
+        seq->sequence.capacity = capacity;
+    }
+    seq->sequence.statements[seq->sequence.count++] = ast;
+}
+
+static int is_flat_sequence(const ast_node *seq) {
+    for (int i = 0; i < seq->sequence.count; ++i) {
+        const ast_node *statement = seq->sequence.statements[i];
+        if (statement == NULL || statement->type == NODE_SEQUENCE) return 0;
+    }
+    return 1;
+}
+
 static int check_type_ignore(value_type current, value_type expected) {
     if (current == TYPE_UNKNOWN) {
         return 0;
@@ -94,12 +298,19 @@ static hashtable *hashtable_empty_cr() {
 //  ------------------------------------------------------------------------  //
 //  ------------------------------------------------------------------------  //
 //  ------------------------------------------------------------------------  //
-static int g_resolving = 0;        // Résolution en cours ?
-static int g_stable;               // Résolution en cours est stable ?
-static algorithms_map *g_algs;     // Algorithmes de la résolution en cours
+static _Thread_local int g_resolving = 0;        // Résolution en cours ?
+static _Thread_local int g_unknown_count;        // Types encore inconnus lors du dernier parcours
+static _Thread_local const ast_node *g_unknown_context;
+static _Thread_local algorithms_map *g_algs;     // Algorithmes de la résolution en cours
+
+static _Thread_local algorithm **g_type_queue;   // File circulaire des algorithmes à reprendre
+static _Thread_local int g_type_queue_size;
+static _Thread_local int g_type_queue_start;
+static _Thread_local int g_type_queue_count;
+static _Thread_local hashtable *g_type_queued;
 
 
-static void unstable_if_unknown(value_type type);
+static void unstable_if_unknown(const ast_node *context, value_type type);
 static value_type get_expr_known_type(ast_node *node, variables_map *vars);
 
 static void resolve_types_in_alg(const char *alg_name, algorithm *alg);
@@ -110,38 +321,86 @@ static void resolve_types_in_binary_operation(ast_node *binary_op, algorithm *cu
 static int check_binary_operation_type(ast_node *op, variables_map *vars, value_type expected_left, value_type expected_right);
 
 
+// File de travail : un algorithme n'est repris que si le type de retour d'un
+//   algorithme qu'il appelle vient d'être déduit. Ses variables locales ne
+//   dépendent que de lui, il est parcouru tant que des types sont déduits.
+static void resolve_types_enqueue(const char *alg_name) {
+    algorithm *alg = hashtable_search(g_type_queued, alg_name);
+    if (alg != NULL || (alg = find_algorithm(g_algs, alg_name)) == NULL) {
+        return;
+    }
+    hashtable_add(g_type_queued, get_alg_name(alg), alg);
+    g_type_queue[(g_type_queue_start + g_type_queue_count++) % g_type_queue_size] = alg;
+}
+
+static void resolve_types_enqueue_alg(const char *alg_name, [[ maybe_unused ]] algorithm *alg) {
+    resolve_types_enqueue(alg_name);
+}
+
+static void resolve_types_check_alg([[ maybe_unused ]] const char *alg_name, algorithm *alg) {
+    g_unknown_count = 0;
+    g_unknown_context = NULL;
+    resolve_types_in_alg(alg_name, alg);
+    if (g_unknown_count > 0) {
+        ERRORAF(g_unknown_context, "Types could not be resolved in algorithm %s, maybe it cannot be determined\n", get_alg_name(alg));
+    }
+    if (get_return_type(alg) == TYPE_UNKNOWN) {
+        ERRORAF(get_alg_tree(alg), "Return type of algorithm %s could not be resolved, maybe it cannot be determined\n", get_alg_name(alg));
+    }
+}
+
 void resolve_types(algorithms_map *algs) {
     if (g_resolving) { ERROR("Cannot call resolve_types during a type resolving\n"); }
     g_resolving = 1;
 
     // Inférence de types
     g_algs = algs;
-    int max_iterations = 1000;
-    do {
-        // stable retourne à 0 si un type de variable locale ou un type
-        // de retour a subit un changement pendant l'itération
-        g_stable = 1;
-
-        foreach_algorithm(algs, resolve_types_in_alg);
-        
-        if (--max_iterations <= 0) {
-            // Exemple de programme qui pourrait faire tourner la boucle autant :
-            // function f():
-            //      return g()
-            // function g():
-            //      return f()
-            // -> Impossible de déterminer les types
-            break;
-            ERROR("Types could not be resolved, maybe it cannot be determined\n");
+    call_graph_order(get_call_graph(algs), &g_type_queue_size);
+    g_type_queue = cralloc(((size_t) g_type_queue_size + 1) * sizeof *g_type_queue);
+    g_type_queue_start = 0;
+    g_type_queue_count = 0;
+    g_type_queued = hashtable_empty_cr();
+    foreach_algorithm_bottom_up(algs, resolve_types_enqueue_alg);
+
+    while (g_type_queue_count > 0) {
+        algorithm *alg = g_type_queue[g_type_queue_start];
+        g_type_queue_start = (g_type_queue_start + 1) % g_type_queue_size;
+        g_type_queue_count--;
+        hashtable_remove(g_type_queued, get_alg_name(alg));
+
+        value_type return_type = get_return_type(alg);
+        int previous;
+        g_unknown_count = INT_MAX;
+        do {
+            previous = g_unknown_count;
+            g_unknown_count = 0;
+            g_unknown_context = NULL;
+            resolve_types_in_alg(get_alg_name(alg), alg);
+        } while (g_unknown_count > 0 && g_unknown_count < previous);
+
+        if (return_type == TYPE_UNKNOWN && get_return_type(alg) != TYPE_UNKNOWN) {
+            int count;
+            const char **callers = call_graph_callers(get_call_graph(algs), get_alg_name(alg), &count);
+            for (int i = 0; i < count; ++i) {
+                resolve_types_enqueue(callers[i]);
+            }
         }
-    } while(g_stable != 1);
+    }
+
+    // Plus rien ne peut être déduit : un type inconnu restant ne le sera jamais
+    // (f renvoie g() et g renvoie f() par exemple)
+    foreach_algorithm_bottom_up(algs, resolve_types_check_alg);
 
+    hashtable_dispose(&g_type_queued);
+    free(g_type_queue);
+    g_type_queue = NULL;
     g_resolving = 0;
 }
 
-void unstable_if_unknown(value_type type) {
+static void unstable_if_unknown(const ast_node *context, value_type type) {
     if (type == TYPE_UNKNOWN) {
-        g_stable = 0;
+        if (g_unknown_context == NULL) g_unknown_context = context;
+        g_unknown_count++;
     }
 }
 
@@ -154,7 +413,7 @@ static value_type get_expr_known_type(ast_node *node, variables_map *vars) {
         case NODE_CONST_BOOL:
             return TYPE_BOOL;
         case NODE_SYMBOL:
-            return get_variable_type(get_variable(vars, node->symbol_name));
+            return get_variable_type(node_variable(node, vars));
         case NODE_UNARY_OPERATOR:
             return node->unary_operator.result_type;
         case NODE_BINARY_OPERATOR:
@@ -184,7 +443,7 @@ static void resolve_types_in_alg([[ maybe_unused ]] const char *alg_name, algori
     if (temp != TYPE_UNKNOWN && temp != expected) {                            \
         ERRORAF(expr, msg_prefix " should have type %s but is of type %s\n", value_type_to_string(expected), value_type_to_string(temp));  \
     }                                                                          \
-    unstable_if_unknown(temp);
+    unstable_if_unknown(expr, temp);
 
 static void resolve_types_in_ast(ast_node *ast, algorithm *current_alg, variables_map *vars) {
     if (ast == NULL) return;
@@ -192,9 +451,9 @@ static void resolve_types_in_ast(ast_node *ast, algorithm *current_alg, variable
     value_type temp;
     switch (ast->type) {
         case NODE_ASSIGNEMENT:
-            variable *assign_to = get_variable(vars, ast->assignement.var_name);
-            resolve_types_in_ast(ast->assignement.expr, current_alg, vars);
-            unstable_if_unknown(unify_variable_type(assign_to, get_expr_known_type(ast->assignement.expr, vars)));
+            variable *assign_to = node_variable(ast, vars);
+            resolve_types_in_ast(node_at(ast->assignement.expr), current_alg, vars);
+            unstable_if_unknown(ast, unify_variable_type(assign_to, get_expr_known_type(node_at(ast->assignement.expr), vars)));
             break;
 
         case NODE_UNARY_OPERATOR:
@@ -206,40 +465,40 @@ static void resolve_types_in_ast(ast_node *ast, algorithm *current_alg, variable
             break;
         
         case NODE_RETURN:
-            resolve_types_in_ast(ast->inst_return.expr, current_alg, vars);
-            unstable_if_unknown(unify_return_type(current_alg, get_expr_known_type(ast->inst_return.expr, vars)));
+            resolve_types_in_ast(node_at(ast->inst_return.expr), current_alg, vars);
+            unstable_if_unknown(ast, unify_return_type(current_alg, get_expr_known_type(node_at(ast->inst_return.expr), vars)));
             break;
         
         case NODE_CALL:
             for (int i = 0; i < ast->call.params_count; ++i) {
-                resolve_types_in_ast(ast->call.parameters_expr[i], current_alg, vars);
-                CHECK_TYPE(ast->call.parameters_expr[i], TYPE_INT, "Parameter of call")
+                resolve_types_in_ast(node_at(ast->call.parameters_expr[i]), current_alg, vars);
+                CHECK_TYPE(node_at(ast->call.parameters_expr[i]), TYPE_INT, "Parameter of call")
             }
             break;
 
         case NODE_IF_STATEMENT:
-            resolve_types_in_ast(ast->if_statement.condition, current_alg, vars);
+            resolve_types_in_ast(node_at(ast->if_statement.condition), current_alg, vars);
             resolve_types_in_ast(ast->if_statement.then_block, current_alg, vars);
             resolve_types_in_ast(ast->if_statement.else_block, current_alg, vars);
-            CHECK_TYPE(ast->if_statement.condition, TYPE_BOOL, "Condition of if statement");
+            CHECK_TYPE(node_at(ast->if_statement.condition), TYPE_BOOL, "Condition of if statement");
             break;
         
         case NODE_DO_FOR_I:
-            if (!variable_exists(vars, ast->do_for_i.var_name)) {
-                create_local(vars, ast->do_for_i.var_name);
+            if (!variable_exists(vars, ast->do_for_i->var_name)) {
+                create_local(vars, ast->do_for_i->var_name);
             }
-            unify_variable_type(get_variable(get_alg_variables(current_alg), ast->do_for_i.var_name), TYPE_INT);
-            resolve_types_in_ast(ast->do_for_i.start_expr, current_alg, vars);
-            resolve_types_in_ast(ast->do_for_i.end_expr, current_alg, vars);
-            resolve_types_in_ast(ast->do_for_i.body, current_alg, vars);
-            CHECK_TYPE(ast->do_for_i.start_expr, TYPE_INT, "First born expression of Do for statement");
-            CHECK_TYPE(ast->do_for_i.end_expr, TYPE_INT, "Second born expression of Do for statement");
+            unify_variable_type(node_variable(ast, vars), TYPE_INT);
+            resolve_types_in_ast(node_at(ast->do_for_i->start_expr), current_alg, vars);
+            resolve_types_in_ast(node_at(ast->do_for_i->end_expr), current_alg, vars);
+            resolve_types_in_ast(ast->do_for_i->body, current_alg, vars);
+            CHECK_TYPE(node_at(ast->do_for_i->start_expr), TYPE_INT, "First born expression of Do for statement");
+            CHECK_TYPE(node_at(ast->do_for_i->end_expr), TYPE_INT, "Second born expression of Do for statement");
             break;
 
         case NODE_DO_WHILE:
-            resolve_types_in_ast(ast->do_while.condition, current_alg, vars);
+            resolve_types_in_ast(node_at(ast->do_while.condition), current_alg, vars);
             resolve_types_in_ast(ast->do_while.body, current_alg, vars);
-            CHECK_TYPE(ast->do_while.condition, TYPE_BOOL, "Condition of while statement");
+            CHECK_TYPE(node_at(ast->do_while.condition), TYPE_BOOL, "Condition of while statement");
             break;
 
         case NODE_FUNCTION:
@@ -247,8 +506,9 @@ static void resolve_types_in_ast(ast_node *ast, algorithm *current_alg, variable
             break;
 
         case NODE_SEQUENCE:
-            resolve_types_in_ast(ast->sequence.first, current_alg, vars);
-            resolve_types_in_ast(ast->sequence.second, current_alg, vars);
+            for (int i = 0; i < ast->sequence.count; ++i) {
+                resolve_types_in_ast(ast->sequence.statements[i], current_alg, vars);
+            }
             break;
 
         default:
@@ -257,10 +517,10 @@ static void resolve_types_in_ast(ast_node *ast, algorithm *current_alg, variable
 }
 
 static void resolve_types_in_unary_operation(ast_node *unary_op, algorithm *current_alg, variables_map *vars) {
-    resolve_types_in_ast(unary_op->unary_operator.operand, current_alg, vars);
+    resolve_types_in_ast(node_at(unary_op->unary_operator.operand), current_alg, vars);
     switch (unary_op->unary_operator.operator) {
         case OP_NOT:
-            if (check_type_expr(unary_op->unary_operator.operand, vars, TYPE_BOOL)) {
+            if (check_type_expr(node_at(unary_op->unary_operator.operand), vars, TYPE_BOOL)) {
                 unary_op->unary_operator.result_type = TYPE_BOOL;
             }
             break;
@@ -268,12 +528,12 @@ static void resolve_types_in_unary_operation(ast_node *unary_op, algorithm *curr
             ERROR("Unmanaged operator\n");
     }
 
-    unstable_if_unknown(unary_op->unary_operator.result_type);
+    unstable_if_unknown(unary_op, unary_op->unary_operator.result_type);
 }
 
 static void resolve_types_in_binary_operation(ast_node *binary_op, algorithm *current_alg, variables_map *vars) {
-    resolve_types_in_ast(binary_op->binary_operator.left, current_alg, vars);
-    resolve_types_in_ast(binary_op->binary_operator.right, current_alg, vars);
+    resolve_types_in_ast(node_at(binary_op->binary_operator.left), current_alg, vars);
+    resolve_types_in_ast(node_at(binary_op->binary_operator.right), current_alg, vars);
     
     switch (binary_op->binary_operator.operator) {
         case OP_ADD:
@@ -291,6 +551,7 @@ static void resolve_types_in_binary_operation(ast_node *binary_op, algorithm *cu
             }
             break;
         case OP_EQUAL: // ne supporte pas bool == bool pour le moment
+        case OP_NEQUAL:
             if (check_binary_operation_type(binary_op, vars, TYPE_INT, TYPE_INT)) {
                 binary_op->binary_operator.result_type = TYPE_BOOL;
             }
@@ -307,12 +568,12 @@ static void resolve_types_in_binary_operation(ast_node *binary_op, algorithm *cu
             ERROR("Unmanaged operator\n");
     }
 
-    unstable_if_unknown(binary_op->binary_operator.result_type);
+    unstable_if_unknown(binary_op, binary_op->binary_operator.result_type);
 }
 
 static int check_binary_operation_type(ast_node *op, variables_map *vars, value_type expected_left, value_type expected_right) {
-    return check_type_expr(op->binary_operator.left, vars, expected_left)
-        && check_type_expr(op->binary_operator.right, vars, expected_right);
+    return check_type_expr(node_at(op->binary_operator.left), vars, expected_left)
+        && check_type_expr(node_at(op->binary_operator.right), vars, expected_right);
 }
 
 
@@ -323,18 +584,32 @@ static int check_binary_operation_type(ast_node *op, variables_map *vars, value_
 //  ------------------------------------------------------------------------  //
 //  ------------------------------------------------------------------------  //
 //  ------------------------------------------------------------------------  //
-static int g_writing = 0;
-static char *sbf;
+static _Thread_local int g_writing = 0;
+static _Thread_local char *sbf;
+
+static _Thread_local algorithms_map *g_walgs;
+static _Thread_local algorithm *g_wcurrent;
+static _Thread_local memo_table *g_wmemo;
+
+// Tables de sauts en attente d'écriture (données et remplissage au départ)
+#define JUMP_TABLE_MIN_CASES 3
+#define JUMP_TABLE_MAX_SPAN 256
+
+struct jump_table {
+    const char *alg_name;   // Son espace de noms de labels
+    int id;
+    int span;
+    int *cases;             // Numéro de cas de chaque indice, -1 : défaut
+};
 
-static algorithms_map *g_walgs;
-static algorithm *g_wcurrent;
+static _Thread_local struct jump_table *g_jump_tables = NULL;
+static _Thread_local int g_jump_tables_count = 0;
 
 static void write_expression_code(ast_node *expr);
 
-static void load_var_address(const char *reg, const char *var_name) {
+static void load_var_address(const char *reg, const variable *var) {
     variables_map *vmap = get_alg_variables(g_wcurrent);
-    variable *var = get_variable(vmap, var_name);
-    CF("Loading address of variable %s into %s", var_name, reg);
+    CF("Loading address of variable %s into %s", get_variable_name(var), reg);
     if (get_variable_semantic(var) == SEM_PARAM) {
         LOAD_PARAM_ADDR(reg, R4, get_variable_pos(var), locals_count(vmap));
     } else {
@@ -355,7 +630,7 @@ static void write_call_function_code(ast_node *cn) {
     PUSH(R1);
     // Empilement des parametres
     for (int i = pcount; i > 0; --i) {
-        write_expression_code(cn->call.parameters_expr[i - 1]);
+        write_expression_code(node_at(cn->call.parameters_expr[i - 1]));
     }
     // Allocation des variables locales et de bp
     for (int i = 0; i < lcount; ++i) {
@@ -377,7 +652,7 @@ static void write_call_function_code(ast_node *cn) {
 }
 
 static void write_unary_operator_code(ast_node *op) {
-    write_expression_code(op->unary_operator.operand);
+    write_expression_code(node_at(op->unary_operator.operand));
     switch (op->unary_operator.operator) {
         case OP_NOT: NOT(); break;
         default:
@@ -386,16 +661,17 @@ static void write_unary_operator_code(ast_node *op) {
 }
 
 static void write_binary_operator_code(ast_node *op) {
-    write_expression_code(op->binary_operator.left);
-    write_expression_code(op->binary_operator.right);
+    write_expression_code(node_at(op->binary_operator.left));
+    write_expression_code(node_at(op->binary_operator.right));
     switch (op->binary_operator.operator) {
         case OP_ADD: ADD(); break;
         case OP_SUB: SUB(); break;
         case OP_MUL: MUL(); break;
-        case OP_DIV: DIV(); break;
+        case OP_DIV: if (op->binary_operator.divisor_nonzero) { DIV_NO_CHECK(); } else { DIV(); } break;
         case OP_AND: AND(); break;
         case OP_OR: OR(); break;
         case OP_EQUAL: EQUAL_OP(); break;
+        case OP_NEQUAL: NOT_EQUAL_OP(); break;
         case OP_SGT: LESS_OP(R2, R1); break; 
         case OP_EGT: LESS_EQ_OP(R2, R1); break; 
         case OP_SLT: LESS_OP(R1, R2); break; 
@@ -405,8 +681,12 @@ static void write_binary_operator_code(ast_node *op) {
     }
 }
 
-static void push_symbol_code(const char *symbol) {
-    load_var_address(R2, symbol);
+static void load_node_var_address(const char *reg, ast_node *node) {
+    load_var_address(reg, node_variable(node, get_alg_variables(g_wcurrent)));
+}
+
+static void push_symbol_code(ast_node *symbol) {
+    load_node_var_address(R2, symbol);
     LOADW(R1, R2);
     PUSH(R1);
 }
@@ -424,7 +704,7 @@ static void write_expression_code(ast_node *expr) {
             if (g_wcurrent == NULL) {
                 ERRORAF(expr, "Tried to access symbol outside of any algorithm: '%s'\n", expr->symbol_name);
             }
-            push_symbol_code(expr->symbol_name);
+            push_symbol_code(expr);
             break;
         case NODE_UNARY_OPERATOR:
             write_unary_operator_code(expr);
@@ -440,14 +720,181 @@ static void write_expression_code(ast_node *expr) {
     }
 }
 
-static void write_assignement_code(const char *var_name, ast_node *expr) {
+// target : assignation ou DOFORI
+static void write_assignement_code(ast_node *target, ast_node *expr) {
     write_expression_code(expr);
-    load_var_address(R2, var_name);
-    CF("Assigning first stack value to %s", var_name);
+    load_node_var_address(R2, target);
+    CF("Assigning first stack value to %s", get_variable_name(node_variable(target, get_alg_variables(g_wcurrent))));
     POP(R1);
     STOREW(R1, R2);
 }
 
+// Calcule l'indice dans la table, et renvoie directement la valeur déjà
+//   calculée si elle y est. Un indice hors table vaut MEMO_NO_INDEX.
+static void write_memo_lookup_code(const memo_table *memo, const char *alg_name) {
+    int memo_count = counter();
+    variables_map *vmap = get_alg_variables(g_wcurrent);
+    C("Memoization lookup");
+    CONSTINT(R1, 0);
+    for (int i = 0; i < params_count(vmap); ++i) {
+        LOAD_PARAM_ADDR(R3, R4, i, locals_count(vmap));
+        LOADW(R2, R3);
+        CONSTINT(R4, memo->lo[i]);
+        EMIT("\tsub %s,%s\n", R2, R4);
+        CONSTINT(R4, memo->stride[i]);
+        EMIT("\tmul %s,%s\n", R2, R4);
+        ADD_R(R1, R2);
+    }
+    load_var_address(R3, memo->index);
+
+    // Indice hors de la table (non signé) : pas de mémoïsation
+    CONSTINT(R2, memo->size);
+    TAGCN("memo_lookup", memo_count, sbf);
+    CONSTSTR(R4, sbf);
+    ULESS(R1, R2);
+    JMPC(R4);
+    CONSTINT(R1, MEMO_NO_INDEX);
+    STOREW(R1, R3);
+    TAGCN("memo_body", memo_count, sbf);
+    CONSTSTR(R4, sbf);
+    JMP(R4);
+
+    TAGC("memo_lookup", memo_count);
+    STOREW(R1, R3);
+    MEMO_ENTRY_ADDR(R3, R1, R4, alg_name);
+    LOADW(R2, R3);
+    CONSTINT(R4, 0);
+    CMP(R2, R4);
+    TAGCN("memo_body", memo_count, sbf);
+    CONSTSTR(R4, sbf);
+    JMPC(R4);
+    CONSTINT(R4, 2);
+    ADD_R(R3, R4);
+    LOADW(R1, R3);
+    PUSH(R1);
+    RETURN(locals_count(vmap) + params_count(vmap));
+
+    TAGC("memo_body", memo_count);
+}
+
+// Enregistre la valeur au sommet de la pile dans la table
+static void write_memo_store_code(const char *alg_name) {
+    int memo_count = counter();
+    C("Memoization store");
+    load_var_address(R3, g_wmemo->index);
+    LOADW(R1, R3);
+    CONSTINT(R4, MEMO_NO_INDEX);
+    CMP(R1, R4);
+    TAGCN("memo_stored", memo_count, sbf);
+    CONSTSTR(R4, sbf);
+    JMPC(R4);
+    MEMO_ENTRY_ADDR(R3, R1, R4, alg_name);
+    CONSTINT(R4, 1);
+    STOREW(R4, R3);
+    CONSTINT(R4, 2);
+    ADD_R(R3, R4);
+    POP(R1);
+    PUSH(R1);
+    STOREW(R1, R3);
+    TAGC("memo_stored", memo_count);
+}
+
+// (symbole == constante) dans un sens ou dans l'autre
+static int match_case_test(const ast_node *cond, ast_node **symbol, int *value) {
+    if (cond->type != NODE_BINARY_OPERATOR || cond->binary_operator.operator != OP_EQUAL) return 0;
+    ast_node *left = node_at(cond->binary_operator.left);
+    ast_node *right = node_at(cond->binary_operator.right);
+    if (right->type == NODE_CONST_INT && left->type == NODE_SYMBOL) {
+        *symbol = left;
+        *value = right->number_value;
+        return 1;
+    }
+    if (left->type == NODE_CONST_INT && right->type == NODE_SYMBOL) {
+        *symbol = right;
+        *value = left->number_value;
+        return 1;
+    }
+    return 0;
+}
+
+// Nombre de cas de la chaîne \IF{x == c0} .. \ELSE \IF{x == c1} .. sur une
+//   même variable, 0 si elle est trop courte ou trop creuse pour une table
+static int jump_table_chain(const ast_node *ast, int *min, int *max) {
+    ast_node *symbol = NULL;
+    ast_node *case_symbol;
+    int value, count = 0;
+    for (const ast_node *node = ast; node != NULL && node->type == NODE_IF_STATEMENT; node = node->if_statement.else_block) {
+        if (!match_case_test(node_at(node->if_statement.condition), &case_symbol, &value)) break;
+        if (symbol != NULL && symbol->symbol_name != case_symbol->symbol_name) break;
+        symbol = case_symbol;
+        if (count == 0 || value < *min) *min = value;
+        if (count == 0 || value > *max) *max = value;
+        count++;
+    }
+    if (count < JUMP_TABLE_MIN_CASES) return 0;
+    long span = (long) *max - *min + 1;
+    if (span > JUMP_TABLE_MAX_SPAN || span > 2 * count) return 0;
+    return count;
+}
+
+static void write_instructions(ast_node *ast);
+
+// Bornes puis saut indirect à travers une table de labels
+static void write_jump_table_code(ast_node *ast, int count, int min, int max) {
+    int table_count = counter();
+    ast_node *symbol;
+    int value;
+    match_case_test(node_at(ast->if_statement.condition), &symbol, &value);
+
+    struct jump_table table = { get_alg_name(g_wcurrent), table_count, max - min + 1, cralloc((size_t) (max - min + 1) * sizeof(int)) };
+    for (int i = 0; i < table.span; ++i) {
+        table.cases[i] = -1;
+    }
+    ast_node *node = ast;
+    for (int k = 0; k < count; ++k, node = node->if_statement.else_block) {
+        match_case_test(node_at(node->if_statement.condition), &symbol, &value);
+        if (table.cases[value - min] == -1) {
+            table.cases[value - min] = k;
+        }
+    }
+    g_jump_tables = realloc(g_jump_tables, (size_t) (g_jump_tables_count + 1) * sizeof *g_jump_tables);
+    if (g_jump_tables == NULL) { ERROR("Could not allocate jump tables\n"); }
+    g_jump_tables[g_jump_tables_count++] = table;
+
+    CF("Jump table No %d on %s (%d cases)", table_count, symbol->symbol_name, count);
+    push_symbol_code(symbol);
+    POP(R1);
+    CONSTINT(R2, min);
+    EMIT("\tsub %s,%s\n", R1, R2);
+    CONSTINT(R2, table.span);
+    TAGCN("jt_lookup", table_count, sbf);
+    CONSTSTR(R3, sbf);
+    ULESS(R1, R2);
+    JMPC(R3);
+    TAGCN("jt_default", table_count, sbf);
+    CONSTSTR(R3, sbf);
+    JMP(R3);
+
+    TAGC("jt_lookup", table_count);
+    JUMP_TABLE_ENTRY_ADDR(R3, R1, R2, g_label_namespace, table_count);
+    LOADW(R3, R3);
+    JMP(R3);
+
+    node = ast;
+    for (int k = 0; k < count; ++k, node = node->if_statement.else_block) {
+        EMIT(":%s__jt_case__%d__%d\n", g_label_namespace, table_count, k);
+        write_instructions(node->if_statement.then_block);
+        TAGCN("jt_end", table_count, sbf);
+        CONSTSTR(R1, sbf);
+        JMP(R1);
+    }
+
+    TAGC("jt_default", table_count);
+    write_instructions(node);
+    TAGC("jt_end", table_count);
+    CF("End of jump table No %d", table_count);
+}
+
 static void write_instructions(ast_node *ast) {
 
     if (ast == NULL) return;
@@ -457,27 +904,42 @@ static void write_instructions(ast_node *ast) {
             sprintf(sbf, TAG_ALGO_PREFIX "%s", ast->function.function_name);
             TAG(sbf);
             FUNC_START();
+            g_wmemo = ast->function.memo;
+            if (g_wmemo != NULL) {
+                write_memo_lookup_code(g_wmemo, ast->function.function_name);
+            }
             write_instructions(ast->function.body);
             FUNC_END_CRASH();
             break;
 
         case NODE_SEQUENCE:
-            write_instructions(ast->sequence.first);
-            write_instructions(ast->sequence.second);
+            for (int i = 0; i < ast->sequence.count; ++i) {
+                write_instructions(ast->sequence.statements[i]);
+            }
             break;
 
         case NODE_ASSIGNEMENT:
-            write_assignement_code(ast->assignement.var_name, ast->assignement.expr);
+            write_assignement_code(ast, node_at(ast->assignement.expr));
             break;
 
         case NODE_RETURN:
-            write_expression_code(ast->inst_return.expr);
+            write_expression_code(node_at(ast->inst_return.expr));
+            if (g_wmemo != NULL) {
+                write_memo_store_code(get_alg_name(g_wcurrent));
+            }
             variables_map *vmap = get_alg_variables(g_wcurrent);
             RETURN(locals_count(vmap) + params_count(vmap));
             break;
 
         case NODE_IF_STATEMENT:
-            write_expression_code(ast->if_statement.condition);
+            int jt_min = 0, jt_max = 0;
+            int jt_cases = jump_table_chain(ast, &jt_min, &jt_max);
+            if (jt_cases > 0) {
+                write_jump_table_code(ast, jt_cases, jt_min, jt_max);
+                break;
+            }
+
+            write_expression_code(node_at(ast->if_statement.condition));
             int if_count = counter();
             CF("IF No %d", if_count);
             if (ast->if_statement.else_block == NULL) {
@@ -513,24 +975,24 @@ static void write_instructions(ast_node *ast) {
             C("Do for loop start");
             int do_for_i_count = counter();
 
-            write_assignement_code(ast->do_for_i.var_name, ast->do_for_i.start_expr);
+            write_assignement_code(ast, node_at(ast->do_for_i->start_expr));
             
             // Début de la boucle
             TAGC("start_for_loop", do_for_i_count);
             TAGCN("end_for_loop", do_for_i_count, sbf);
             CONSTSTR(R4, sbf);
             
-            write_expression_code(ast->do_for_i.end_expr);
+            write_expression_code(node_at(ast->do_for_i->end_expr));
             POP(R1);
-            load_var_address(R3, ast->do_for_i.var_name);
+            load_node_var_address(R3, ast);
             LOADW(R2, R3);
 
             ULESS(R1, R2);
             JMPC(R4);
 
-            write_instructions(ast->do_for_i.body);
+            write_instructions(ast->do_for_i->body);
 
-            load_var_address(R3, ast->do_for_i.var_name);
+            load_node_var_address(R3, ast);
             CONSTINT(R2, 1);
             LOADW(R1, R3);
             ADD_R(R1, R2);
@@ -552,7 +1014,7 @@ static void write_instructions(ast_node *ast) {
             TAGC("start_while_loop", do_while_count);
 
             // Evaluer la condition, jmp à la fin si !condition
-            write_expression_code(ast->do_while.condition);
+            write_expression_code(node_at(ast->do_while.condition));
             TAGCN("end_while_loop", do_while_count, sbf);
             CONSTSTR(R3, sbf);
             POP(R1);
@@ -577,7 +1039,7 @@ static void write_instructions(ast_node *ast) {
             // Calcul des nouvelles valeurs
             variables_map *vars = get_alg_variables(g_wcurrent);
             for (int i = 0; i < params_count(vars); ++i) {
-                write_expression_code(ast->spec_params_reassign.parameters_expr[i]);
+                write_expression_code(node_at(ast->spec_params_reassign.parameters_expr[i]));
             }
             // Assignations aux parametres
             for (int i = params_count(vars) - 1; i >= 0; --i) {
@@ -592,11 +1054,80 @@ static void write_instructions(ast_node *ast) {
     }
 }
 
-static void write_instructions_pre([[ maybe_unused ]] const char *alg_name, algorithm *alg) {
-    sbf = cralloc(2048);
-    g_wcurrent = alg;
-    write_instructions(get_alg_tree(alg));
+// Code d'un algorithme, écrit par une tâche dans son propre tampon
+struct alg_code {
+    algorithm *alg;
+    char *text;
+    size_t size;
+    struct jump_table *jump_tables;
+    int jump_tables_count;
+};
+
+struct code_writing {
+    ast_passes_state passes;
+    algorithms_map *algs;
+    struct alg_code *codes;
+};
+
+static void free_jump_tables(struct jump_table *tables, int count) {
+    for (int t = 0; t < count; ++t) {
+        free(tables[t].cases);
+    }
+    free(tables);
+}
+
+// Fin de l'écriture d'un algorithme, interrompue ou non
+static void end_alg_writing(FILE *output, char *label_namespace) {
+    g_instructions_output = NULL;
+    g_label_namespace = MAIN_LABEL_NAMESPACE;
+    free(label_namespace);
     free(sbf);
+    sbf = NULL;
+    fclose(output);
+}
+
+static void write_instructions_pre(int index, void *context) {
+    struct code_writing *writing = context;
+    struct alg_code *code = &writing->codes[index];
+    restore_ast_passes(&writing->passes);
+    FILE *output = open_memstream(&code->text, &code->size);
+    if (output == NULL) { ERROR("Could not open the algorithm output stream\n"); }
+
+    // État de l'écriture propre au thread de la tâche
+    sbf = cralloc(2048);
+    char *label_namespace = cralloc(strlen(TAG_ALGO_PREFIX) + strlen(get_alg_name(code->alg)) + 1);
+    sprintf(label_namespace, TAG_ALGO_PREFIX "%s", get_alg_name(code->alg));
+    g_label_namespace = label_namespace;
+    reset_counter();
+    g_instructions_output = output;
+    g_algs = writing->algs;
+    g_walgs = writing->algs;
+    g_wcurrent = code->alg;
+    g_jump_tables = NULL;
+    g_jump_tables_count = 0;
+
+    // Tampons de l'algorithme libérés avant de signaler l'erreur à nouveau
+    diagnostic error;
+    jmp_buf handler;
+    error_handler previous = set_error_handler(&handler, &error);
+    if (setjmp(handler) != 0) {
+        restore_error_handler(previous);
+        free_jump_tables(g_jump_tables, g_jump_tables_count);
+        g_jump_tables = NULL;
+        g_jump_tables_count = 0;
+        end_alg_writing(output, label_namespace);
+        free(code->text);
+        code->text = NULL;
+        report_error(error.line, "%s", error.message);
+    }
+    write_instructions(get_alg_tree(code->alg));
+    restore_error_handler(previous);
+
+    code->jump_tables = g_jump_tables;
+    code->jump_tables_count = g_jump_tables_count;
+    g_jump_tables = NULL;
+    g_jump_tables_count = 0;
+    end_alg_writing(output, label_namespace);
 }
 
 static void write_start_code() {
@@ -604,50 +1135,143 @@ static void write_start_code() {
     JMP(R1);
     
     TAG("newline");
-    printf("@string \"\\n\"\n");
+    EMIT("@string \"\\n\"\n");
 
     ERRORTAG(ERROR_DIVISION_BY_ZERO, "Division by zero error");
 }
 
+// Les labels ne sont connus que par const : les tables sont remplies au départ
+static void write_jump_tables_fill_code() {
+    for (int t = 0; t < g_jump_tables_count; ++t) {
+        CF("Filling jump table No %d of %s", g_jump_tables[t].id, g_jump_tables[t].alg_name);
+        sprintf(sbf, TAG_ALGO_PREFIX "%s", g_jump_tables[t].alg_name);
+        for (int i = 0; i < g_jump_tables[t].span; ++i) {
+            if (g_jump_tables[t].cases[i] == -1) {
+                EMIT("\tconst %s,%s__jt_default__%d\n", R1, sbf, g_jump_tables[t].id);
+            } else {
+                EMIT("\tconst %s,%s__jt_case__%d__%d\n", R1, sbf, g_jump_tables[t].id, g_jump_tables[t].cases[i]);
+            }
+            CONSTINT(R2, i);
+            JUMP_TABLE_ENTRY_ADDR(R3, R2, R4, sbf, g_jump_tables[t].id);
+            STOREW(R1, R3);
+        }
+    }
+}
+
+static void write_jump_tables_data() {
+    for (int t = 0; t < g_jump_tables_count; ++t) {
+        EMIT(":" TAG_ALGO_PREFIX "%s__jtable__%d\n", g_jump_tables[t].alg_name, g_jump_tables[t].id);
+        for (int i = 0; i < g_jump_tables[t].span; ++i) {
+            EMIT("@int 0\n");
+        }
+        free(g_jump_tables[t].cases);
+    }
+    free(g_jump_tables);
+    g_jump_tables = NULL;
+    g_jump_tables_count = 0;
+}
+
+static void write_memo_table([[ maybe_unused ]] const char *alg_name, algorithm *alg) {
+    memo_table *memo = get_alg_tree(alg)->function.memo;
+    if (memo == NULL) return;
+    sprintf(sbf, TAG_MEMO_PREFIX "%s", get_alg_name(alg));
+    TAG(sbf);
+    for (int i = 0; i < 2 * memo->size; ++i) {
+        EMIT("@int 0\n");
+    }
+}
+
 static void write_end_code(ast_node *main_call) {
+    if (main_call == NULL || main_call->type != NODE_CALL) {
+        ERROR("There is no main call\n");
+    }
+    sbf = cralloc(2048);
     TAG("start");
 
     // Initialisation de la pile
     CONSTSTR(RBP, "pile");
     CONSTSTR(RSP, "pile");
     CONSTINT(R1, 2);
-    printf("\tsub %s,%s\n", RSP, R1);
+    EMIT("\tsub %s,%s\n", RSP, R1);
+
+    write_jump_tables_fill_code();
 
     // Appel de la fonction "main"
     C("Appel principal");
-    if (main_call == NULL || main_call->type != NODE_CALL) {
-        ERROR("There is no main call\n");
-    }
     write_call_function_code(main_call);
 
     // Affichage et fin
     C("Ici affichage de la valeur en haut de la pile et fin du programme");
     CONSTSTR(R1, "newline");
     CP(R2, RSP);
-    printf("\tcallprintfd %s\n", R2);
-    printf("\tcallprintfs %s\n", R1);
-    printf("\tend\n");
+    EMIT("\tcallprintfd %s\n", R2);
+    EMIT("\tcallprintfs %s\n", R1);
+    EMIT("\tend\n");
+
+    // Tables de mémoïsation, avant la pile qui grandit vers le haut
+    foreach_algorithm(g_walgs, write_memo_table);
+    write_jump_tables_data();
 
     TAG("pile");
-    printf("@int 0\n");
+    EMIT("@int 0\n");
+    free(sbf);
+    sbf = NULL;
 }
 
-void write_all_instructions(algorithms_map *algs, ast_node *main_call) {
+void write_all_instructions(algorithms_map *algs, ast_node *main_call, FILE *output, int jobs) {
     if (g_writing != 0) { ERROR("Cannot write code while code is already being written\n"); }
     g_writing = 1;
 
+    // Chaque algorithme est écrit dans son tampon, puis les tampons sont
+    //   recopiés dans l'ordre du parcours, quel que soit l'ordonnancement
+    int count;
+    algorithm **ordered = get_algorithms(algs, 0, &count);
+    struct code_writing writing = { save_ast_passes(), algs, cralloc(((size_t) count + 1) * sizeof *writing.codes) };
+    for (int i = 0; i < count; ++i) {
+        writing.codes[i] = (struct alg_code) { .alg = ordered[i], .text = NULL, .size = 0, .jump_tables = NULL, .jump_tables_count = 0 };
+    }
+    free(ordered);
+
+    // Une erreur d'écriture est signalée à nouveau une fois les tampons
+    //   des algorithmes déjà écrits libérés
+    diagnostic error;
+    jmp_buf handler;
+    error_handler previous = set_error_handler(&handler, &error);
+    if (setjmp(handler) != 0) {
+        restore_error_handler(previous);
+        for (int i = 0; i < count; ++i) {
+            free(writing.codes[i].text);
+            free_jump_tables(writing.codes[i].jump_tables, writing.codes[i].jump_tables_count);
+        }
+        free(writing.codes);
+        g_writing = 0;
+        report_error(error.line, "%s", error.message);
+    }
+    parallel_for(count, jobs, write_instructions_pre, &writing);
+    restore_error_handler(previous);
+
+    g_instructions_output = output;
+    g_label_namespace = MAIN_LABEL_NAMESPACE;
+    reset_counter();
     g_walgs = algs;
     g_wcurrent = NULL;
     write_start_code();
-    foreach_algorithm(algs, write_instructions_pre);
-    g_wcurrent = NULL;
+    for (int i = 0; i < count; ++i) {
+        struct alg_code *code = &writing.codes[i];
+        fwrite(code->text, 1, code->size, output);
+        free(code->text);
+        for (int t = 0; t < code->jump_tables_count; ++t) {
+            g_jump_tables = realloc(g_jump_tables, (size_t) (g_jump_tables_count + 1) * sizeof *g_jump_tables);
+            if (g_jump_tables == NULL) { ERROR("Could not allocate jump tables\n"); }
+            g_jump_tables[g_jump_tables_count++] = code->jump_tables[t];
+        }
+        free(code->jump_tables);
+    }
+    free(writing.codes);
     write_end_code(main_call);
+    fflush(output);
 
+    g_instructions_output = NULL;
     g_writing = 0;
 }
 
@@ -659,8 +1283,6 @@ void write_all_instructions(algorithms_map *algs, ast_node *main_call) {
 //  ------------------------------------------------------------------------  //
 //  ------------------------------------------------------------------------  //
 //  ------------------------------------------------------------------------  //
-static const char *check_all_vars_assigned_aux(ast_node *ast, hashtable **assigned, int depth);
-
 static int check_all_path_returns(ast_node *ast) {
     if (ast == NULL) {
         return 0;
@@ -670,17 +1292,19 @@ static int check_all_path_returns(ast_node *ast) {
         case NODE_RETURN:
             return 1;
         case NODE_SEQUENCE:
-            return check_all_path_returns(ast->sequence.first)
-                || check_all_path_returns(ast->sequence.second);
+            for (int i = 0; i < ast->sequence.count; ++i) {
+                if (check_all_path_returns(ast->sequence.statements[i])) return 1;
+            }
+            return 0;
         case NODE_IF_STATEMENT:
             return check_all_path_returns(ast->if_statement.then_block)
                 && check_all_path_returns(ast->if_statement.else_block);
         case NODE_DO_FOR_I:
-            return check_all_path_returns(ast->do_for_i.body);
+            return check_all_path_returns(ast->do_for_i->body);
         case NODE_DO_WHILE:
             return check_all_path_returns(ast->do_while.body)
-                || (ast->do_while.condition->type == NODE_CONST_BOOL
-                    && ast->do_while.condition->number_value != 0); // Fix temporaire ?
+                || (node_at(ast->do_while.condition)->type == NODE_CONST_BOOL
+                    && node_at(ast->do_while.condition)->number_value != 0); // Fix temporaire ?
         
         case NODE_ASSIGNEMENT:
         case NODE_FUNCTION:
@@ -692,27 +1316,81 @@ static int check_all_path_returns(ast_node *ast) {
     }
 }
 
-static const char *check_all_vars_assigned_expr(ast_node *expr, hashtable *assigned) {
+// Variables numérotées de façon dense (paramètres puis locales), les
+//   variables assignées sont un ensemble de bits. Chaque branche ouverte
+//   travaille sur une copie, réservée une fois pour toute la profondeur.
+typedef unsigned long long cv_word;
+#define CV_WORD_BITS ((int) (8 * sizeof(cv_word)))
+
+static _Thread_local variables_map *g_cv_vars;
+static _Thread_local cv_word *g_cv_sets;
+static _Thread_local size_t g_cv_words;
+
+static const char *check_all_vars_assigned_aux(ast_node *ast, cv_word *assigned, int depth);
+
+// node : symbole, assignation ou DOFORI
+static int cv_is_assigned(const cv_word *assigned, ast_node *node) {
+    int i = get_variable_id(g_cv_vars, node_variable(node, g_cv_vars));
+    return (assigned[i / CV_WORD_BITS] >> (i % CV_WORD_BITS)) & 1;
+}
+
+static void cv_assign(cv_word *assigned, ast_node *node) {
+    int i = get_variable_id(g_cv_vars, node_variable(node, g_cv_vars));
+    assigned[i / CV_WORD_BITS] |= (cv_word) 1 << (i % CV_WORD_BITS);
+}
+
+// Copie de assigned pour une branche ouverte à la profondeur depth
+static cv_word *cv_branch(const cv_word *assigned, int depth, int branch) {
+    cv_word *copy = g_cv_sets + (size_t) (1 + 2 * depth + branch) * g_cv_words;
+    memcpy(copy, assigned, g_cv_words * sizeof *copy);
+    return copy;
+}
+
+static int cv_max_depth(const ast_node *ast) {
+    if (ast == NULL) return 0;
+    int d1, d2;
+    switch (ast->type) {
+        case NODE_SEQUENCE:
+            d1 = 0;
+            for (int i = 0; i < ast->sequence.count; ++i) {
+                d2 = cv_max_depth(ast->sequence.statements[i]);
+                if (d2 > d1) d1 = d2;
+            }
+            return d1;
+        case NODE_IF_STATEMENT:
+            d1 = cv_max_depth(ast->if_statement.then_block);
+            d2 = cv_max_depth(ast->if_statement.else_block);
+            return 1 + (d1 > d2 ? d1 : d2);
+        case NODE_DO_FOR_I:
+            return 1 + cv_max_depth(ast->do_for_i->body);
+        case NODE_DO_WHILE:
+            return 1 + cv_max_depth(ast->do_while.body);
+        default:
+            return 0;
+    }
+}
+
+static const char *check_all_vars_assigned_expr(ast_node *expr, const cv_word *assigned) {
     if (expr == NULL) { ERROR("Expression is null (checking)\n"); }
 
     const char *tmp;
     switch (expr->type) {
         case NODE_SYMBOL:
-            if (hashtable_search(assigned, expr->symbol_name) == NULL) {
+            if (!cv_is_assigned(assigned, expr)) {
                 return expr->symbol_name;
             }
             return NULL;
         case NODE_CALL:
             for (int i = 0; i < expr->call.params_count; ++i) {
-                tmp = check_all_vars_assigned_expr(expr->call.parameters_expr[i], assigned);
+                tmp = check_all_vars_assigned_expr(node_at(expr->call.parameters_expr[i]), assigned);
                 if (tmp != NULL) return tmp;
             }
             return NULL;
         case NODE_UNARY_OPERATOR:
-            return check_all_vars_assigned_expr(expr->unary_operator.operand, assigned);
+            return check_all_vars_assigned_expr(node_at(expr->unary_operator.operand), assigned);
         case NODE_BINARY_OPERATOR:
-            tmp = check_all_vars_assigned_expr(expr->binary_operator.left, assigned);
-            return tmp != NULL ? tmp : check_all_vars_assigned_expr(expr->binary_operator.right, assigned);
+            tmp = check_all_vars_assigned_expr(node_at(expr->binary_operator.left), assigned);
+            return tmp != NULL ? tmp : check_all_vars_assigned_expr(node_at(expr->binary_operator.right), assigned);
 
         case NODE_CONST_INT:
         case NODE_CONST_BOOL:
@@ -723,79 +1401,67 @@ static const char *check_all_vars_assigned_expr(ast_node *expr, hashtable *assig
     }
 }
 
-static hashtable **cv_add_depth(hashtable **assigned, int current_depth) {
-    assigned[current_depth + 1] = hashtable_empty_cr();
-    hashtable_extend(assigned[current_depth + 1], assigned[current_depth]);
-    return assigned;
-}
-
-static void cv_rm_depth(hashtable **hashtables, int current_depth) {
-    hashtable_dispose(&hashtables[current_depth + 1]);
-}
-
-static const char *cv_if_node(ast_node *ast, hashtable **assigned, int depth) {
-    const char *tmp = check_all_vars_assigned_aux(ast->if_statement.then_block, cv_add_depth(assigned, depth), depth + 1);
+static const char *cv_if_node(ast_node *ast, cv_word *assigned, int depth) {
+    cv_word *then_assigned = cv_branch(assigned, depth, 0);
+    const char *tmp = check_all_vars_assigned_aux(ast->if_statement.then_block, then_assigned, depth + 1);
     if (tmp != NULL) {
         return tmp;
     }
-    hashtable *h1 = hashtable_empty_cr();
-    hashtable_extend(h1, assigned[depth + 1]);
-    cv_rm_depth(assigned, depth);
-    tmp = check_all_vars_assigned_aux(ast->if_statement.else_block, cv_add_depth(assigned, depth), depth + 1);
+    cv_word *else_assigned = cv_branch(assigned, depth, 1);
+    tmp = check_all_vars_assigned_aux(ast->if_statement.else_block, else_assigned, depth + 1);
     if (tmp != NULL) {
         return tmp;
     }
 
-    int commons_count;
-    char **commons = (char **) hashtable_inter(h1, assigned[depth + 1], &commons_count);
-    for (int i = 0; i < commons_count; ++i) {
-        hashtable_add(assigned[depth], commons[i], commons[i]);
+    // Assignées par les deux branches
+    for (size_t i = 0; i < g_cv_words; ++i) {
+        assigned[i] = then_assigned[i] & else_assigned[i];
     }
-
     return NULL;
 }
 
-static const char *check_all_vars_assigned_aux(ast_node *ast, hashtable **assigned, int depth) {
+static const char *check_all_vars_assigned_aux(ast_node *ast, cv_word *assigned, int depth) {
     if (ast == NULL) return NULL;
 
     const char *tmp;
+    cv_word *body_assigned;
     switch (ast->type) {
         case NODE_ASSIGNEMENT:
-            tmp = check_all_vars_assigned_expr(ast->assignement.expr, assigned[depth]);
+            tmp = check_all_vars_assigned_expr(node_at(ast->assignement.expr), assigned);
             if (tmp != NULL) return tmp;
-            hashtable_add(assigned[depth], ast->assignement.var_name, ast->assignement.expr);
+            cv_assign(assigned, ast);
             return NULL;
 
         case NODE_SEQUENCE:
-            tmp = check_all_vars_assigned_aux(ast->sequence.first, assigned, depth);
-            return tmp != NULL ? tmp : check_all_vars_assigned_aux(ast->sequence.second, assigned, depth);
+            for (int i = 0; i < ast->sequence.count; ++i) {
+                tmp = check_all_vars_assigned_aux(ast->sequence.statements[i], assigned, depth);
+                if (tmp != NULL) return tmp;
+            }
+            return NULL;
 
         case NODE_RETURN:
-            return check_all_vars_assigned_expr(ast->inst_return.expr, assigned[depth]);
+            return check_all_vars_assigned_expr(node_at(ast->inst_return.expr), assigned);
 
         case NODE_IF_STATEMENT:
             return cv_if_node(ast, assigned, depth);
 
         case NODE_DO_FOR_I:
-            tmp = check_all_vars_assigned_expr(ast->do_for_i.start_expr, assigned[depth]);
-            if (tmp == NULL) tmp = check_all_vars_assigned_expr(ast->do_for_i.end_expr, assigned[depth]);
+            tmp = check_all_vars_assigned_expr(node_at(ast->do_for_i->start_expr), assigned);
+            if (tmp == NULL) tmp = check_all_vars_assigned_expr(node_at(ast->do_for_i->end_expr), assigned);
             if (tmp != NULL) return tmp;
-            cv_add_depth(assigned, depth);
-            hashtable_add(assigned[depth + 1], ast->do_for_i.var_name, ast->do_for_i.start_expr);
-            tmp = check_all_vars_assigned_aux(ast->do_for_i.body, assigned, depth + 1);
-            cv_rm_depth(assigned, depth);
-            return tmp;
+            body_assigned = cv_branch(assigned, depth, 0);
+            cv_assign(body_assigned, ast);
+            return check_all_vars_assigned_aux(ast->do_for_i->body, body_assigned, depth + 1);
 
         case NODE_DO_WHILE:
-            tmp = check_all_vars_assigned_expr(ast->do_while.condition, assigned[depth]);
+            tmp = check_all_vars_assigned_expr(node_at(ast->do_while.condition), assigned);
             if (tmp != NULL) return tmp;
-            tmp = check_all_vars_assigned_aux(ast->do_while.body, cv_add_depth(assigned, depth), depth + 1);
-            cv_rm_depth(assigned, depth);
-            return tmp;
+            body_assigned = cv_branch(assigned, depth, 0);
+            return check_all_vars_assigned_aux(ast->do_while.body, body_assigned, depth + 1);
         
         case NODE_SPEC_PARAMS_REASSIGN:
             for (int i = 0; i < ast->spec_params_reassign.params_count; ++i) {
-                tmp = check_all_vars_assigned_expr(ast->spec_params_reassign.parameters_expr[i], assigned[depth]);
+                tmp = check_all_vars_assigned_expr(node_at(ast->spec_params_reassign.parameters_expr[i]), assigned);
                 if (tmp != NULL) return tmp;
             }
             return NULL;
@@ -806,19 +1472,33 @@ static const char *check_all_vars_assigned_aux(ast_node *ast, hashtable **assign
 }
 
 static const char *check_all_vars_assigned(ast_node *ast, algorithms_map *algs) {
-    hashtable **assigned = malloc(MAX_SCOPE_DEPTH * sizeof *assigned);
-    assigned[0] = hashtable_empty_cr();
-
-    // Ajoute les parametres comme étant définis par défaut
     algorithm *current = get_algorithm(algs, ast->function.function_name);
-    const char **pnames = get_all_param_names(get_alg_variables(current));
-    for (int i = 0; pnames[i] != NULL; ++i) {
-        hashtable_add(assigned[0], pnames[i], pnames[i]);
+    g_cv_vars = get_alg_variables(current);
+    int count = params_count(g_cv_vars) + locals_count(g_cv_vars);
+    g_cv_words = (size_t) (count / CV_WORD_BITS + 1);
+    g_cv_sets = cralloc((size_t) (1 + 2 * cv_max_depth(ast->function.body)) * g_cv_words * sizeof *g_cv_sets);
+    memset(g_cv_sets, 0, g_cv_words * sizeof *g_cv_sets);
+
+    // Les parametres sont définis par défaut
+    for (int i = 0; i < params_count(g_cv_vars); ++i) {
+        g_cv_sets[i / CV_WORD_BITS] |= (cv_word) 1 << (i % CV_WORD_BITS);
     }
 
-    const char *result = check_all_vars_assigned_aux(ast->function.body, assigned, 0);
-    hashtable_dispose(&assigned[0]);
-    free(assigned);
+    // Appelée dans les tâches de check_code : l'ensemble est libéré par son
+    //   thread avant de signaler l'erreur à nouveau
+    diagnostic error;
+    jmp_buf handler;
+    error_handler previous = set_error_handler(&handler, &error);
+    if (setjmp(handler) != 0) {
+        restore_error_handler(previous);
+        free(g_cv_sets);
+        g_cv_sets = NULL;
+        report_error(error.line, "%s", error.message);
+    }
+    const char *result = check_all_vars_assigned_aux(ast->function.body, g_cv_sets, 0);
+    restore_error_handler(previous);
+    free(g_cv_sets);
+    g_cv_sets = NULL;
     return result;
 }
 
@@ -838,208 +1518,2594 @@ void check_ast_code(ast_node *ast, algorithms_map *algs) {
 //  ------------------------------------------------------------------------  //
 //  ------------------------------------------------------------------------  //
 //  ------------------------------------------------------------------------  //
-//  ------------------------   Optimisation d'AST   ------------------------  //
+//  ---------------------   Algorithmes accessibles   ----------------------  //
 //  ------------------------------------------------------------------------  //
 //  ------------------------------------------------------------------------  //
 //  ------------------------------------------------------------------------  //
-static int g_odebug = 0;
-static int g_ochanged;
-
-#define O_DEBUGF(fmt, ...) if (g_odebug) { printf("-> " fmt "\n", __VA_ARGS__); }
-#define O_DEBUG(str) O_DEBUGF("%s", str);
-
-#define OC() (g_ochanged++)
-
-#define RIGHT(expr) ((expr)->binary_operator.right)
-#define LEFT(expr) ((expr)->binary_operator.left)
-
-#define IS_INT_CONST(val) ((val)->type == NODE_CONST_INT)
-#define IS_BOOL_CONST(val) ((val)->type == NODE_CONST_BOOL)
-
-#define IS_ZERO(val) (IS_INT_CONST(val) && (val)->number_value == 0)
-#define IS_ONE(val) (IS_INT_CONST(val) && (val)->number_value == 1)
-#define IS_TRUE(val) (IS_BOOL_CONST(val) && (val)->number_value != 0)
-#define IS_FALSE(val) (IS_BOOL_CONST(val) && (val)->number_value == 0)
+//  Seuls les algorithmes appelés, directement ou non, par l'appel principal
+//    sont optimisés et écrits.
+static _Thread_local algorithms_map *g_reach_algs;
+static _Thread_local int g_reach_count;
 
-#define TEST_LEFT_RIGHT(expr, test) (test((expr)->binary_operator.left) && test((expr)->binary_operator.right))
-
-#define MKVAL(expr, op, make_new) make_new((expr)->binary_operator.left->number_value op (expr)->binary_operator.right->number_value)
-
-#define CONCAT_2VAL(expr, op, is_const, mk_new, type_str) if (TEST_LEFT_RIGHT(expr, is_const)) { (expr) = MKVAL(expr, op, mk_new); OC(); O_DEBUG("Precalc " type_str " const expression " #op); break; }
+static void mark_reachable_in_ast(const ast_node *ast) {
+    if (ast == NULL) return;
+    switch (ast->type) {
+        case NODE_UNARY_OPERATOR:
+            mark_reachable_in_ast(node_at(ast->unary_operator.operand));
+            break;
+        case NODE_BINARY_OPERATOR:
+            mark_reachable_in_ast(node_at(ast->binary_operator.left));
+            mark_reachable_in_ast(node_at(ast->binary_operator.right));
+            break;
+        case NODE_CALL:
+            for (int i = 0; i < ast->call.params_count; ++i) {
+                mark_reachable_in_ast(node_at(ast->call.parameters_expr[i]));
+            }
+            algorithm *callee = get_algorithm(g_reach_algs, ast->call.function_name);
+            if (!is_alg_reachable(callee)) {
+                set_alg_reachable(callee, 1);
+                g_reach_count++;
+                mark_reachable_in_ast(get_alg_tree(callee));
+            }
+            break;
+        case NODE_ASSIGNEMENT:
+            mark_reachable_in_ast(node_at(ast->assignement.expr));
+            break;
+        case NODE_RETURN:
+            mark_reachable_in_ast(node_at(ast->inst_return.expr));
+            break;
+        case NODE_IF_STATEMENT:
+            mark_reachable_in_ast(node_at(ast->if_statement.condition));
+            mark_reachable_in_ast(ast->if_statement.then_block);
+            mark_reachable_in_ast(ast->if_statement.else_block);
+            break;
+        case NODE_DO_FOR_I:
+            mark_reachable_in_ast(node_at(ast->do_for_i->start_expr));
+            mark_reachable_in_ast(node_at(ast->do_for_i->end_expr));
+            mark_reachable_in_ast(ast->do_for_i->body);
+            break;
+        case NODE_DO_WHILE:
+            mark_reachable_in_ast(node_at(ast->do_while.condition));
+            mark_reachable_in_ast(ast->do_while.body);
+            break;
+        case NODE_FUNCTION:
+            mark_reachable_in_ast(ast->function.body);
+            break;
+        case NODE_SEQUENCE:
+            for (int i = 0; i < ast->sequence.count; ++i) {
+                mark_reachable_in_ast(ast->sequence.statements[i]);
+            }
+            break;
+        case NODE_SPEC_PARAMS_REASSIGN:
+            for (int i = 0; i < ast->spec_params_reassign.params_count; ++i) {
+                mark_reachable_in_ast(node_at(ast->spec_params_reassign.parameters_expr[i]));
+            }
+            break;
+        default:
+            break;
+    }
+}
 
-#define CONCAT_2INT(expr, op) CONCAT_2VAL(expr, op, IS_INT_CONST, make_int, "int");
-#define CONCAT_2BOOL(expr, op) CONCAT_2VAL(expr, op, IS_BOOL_CONST, make_bool, "bool");
-#define CONCAT_2INT_RBOOL(expr, op) CONCAT_2VAL(expr, op, IS_INT_CONST, make_bool, "bool condition")
+int mark_reachable_algorithms(algorithms_map *algs, ast_node *main_call) {
+    g_reach_algs = algs;
+    g_reach_count = 0;
+    mark_reachable_in_ast(main_call);
+    return g_reach_count;
+}
 
-#define KEEP_LEFT(expr, condition) if (condition) { (expr) = (expr)->binary_operator.left; OC(); O_DEBUG("Keeping left side of operation"); break; }
-#define KEEP_RIGHT(expr, condition) if (condition) { (expr) = (expr)->binary_operator.right; OC(); O_DEBUG("Keeping right side of operation"); break; }
 
-#define IS_SYMBOL(val) ((val)->type == NODE_SYMBOL)
-#define ARE_SAME_SYMBOL(s1, s2) (IS_SYMBOL(s1) && IS_SYMBOL(s2) && strcmp((s1)->symbol_name, (s2)->symbol_name) == 0)
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  ----------------------   Effets des algorithmes   ----------------------  //
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  Un algorithme est pur s'il ne peut rien afficher, c'est à dire échouer sur
+//    une division par zéro, ni appeler un algorithme qui le pourrait. Il
+//    termine si ses boucles sont bornées, s'il n'est pas récursif et si tous
+//    les algorithmes qu'il appelle terminent.
+static _Thread_local int g_effects_changed;
+
+// La division peut échouer et afficher une erreur
+static int may_fail_division(const ast_node *expr) {
+    return expr->binary_operator.operator == OP_DIV
+        && !expr->binary_operator.divisor_nonzero
+        && !(node_at(expr->binary_operator.right)->type == NODE_CONST_INT && node_at(expr->binary_operator.right)->number_value != 0);
+}
 
-static void optimize_expr(ast_node **expr_ptr) {
-    ast_node *expr = *expr_ptr;
+static int call_has_no_effect(const ast_node *call) {
+    if (g_passes.effects_algs == NULL) return 0;
+    algorithm *callee = get_algorithm(g_passes.effects_algs, call->call.function_name);
+    return is_alg_pure(callee) && is_alg_terminating(callee);
+}
 
-    switch ((*expr_ptr)->type) {
+// Symbole lu par l'expression
+static int expr_reads_symbol(const ast_node *expr, const char *symbol) {
+    switch (expr->type) {
+        case NODE_SYMBOL:
+            return expr->symbol_name == symbol;
+        case NODE_UNARY_OPERATOR:
+            return expr_reads_symbol(node_at(expr->unary_operator.operand), symbol);
+        case NODE_BINARY_OPERATOR:
+            return expr_reads_symbol(node_at(expr->binary_operator.left), symbol) || expr_reads_symbol(node_at(expr->binary_operator.right), symbol);
+        case NODE_CALL:
+            for (int i = 0; i < expr->call.params_count; ++i) {
+                if (expr_reads_symbol(node_at(expr->call.parameters_expr[i]), symbol)) return 1;
+            }
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+// Une instruction du bloc modifie une variable lue par expr
+static int block_writes_expr(const ast_node *ast, const ast_node *expr) {
+    if (ast == NULL) return 0;
+    switch (ast->type) {
+        case NODE_SEQUENCE:
+            for (int i = 0; i < ast->sequence.count; ++i) {
+                if (block_writes_expr(ast->sequence.statements[i], expr)) return 1;
+            }
+            return 0;
+        case NODE_ASSIGNEMENT:
+            return expr_reads_symbol(expr, ast->assignement.var_name);
+        case NODE_IF_STATEMENT:
+            return block_writes_expr(ast->if_statement.then_block, expr) || block_writes_expr(ast->if_statement.else_block, expr);
+        case NODE_DO_FOR_I:
+            return expr_reads_symbol(expr, ast->do_for_i->var_name) || block_writes_expr(ast->do_for_i->body, expr);
+        case NODE_DO_WHILE:
+            return block_writes_expr(ast->do_while.body, expr);
+        case NODE_SPEC_PARAMS_REASSIGN:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// Une boucle DOFORI s'arrête si sa borne ne bouge pas et ne vaut jamais
+//   0xFFFF, seule valeur que le compteur ne peut pas dépasser (uless)
+static int is_bounded_loop(const ast_node *loop) {
+    const ast_node *end = node_at(loop->do_for_i->end_expr);
+    ast_node var = { .type = NODE_SYMBOL, .symbol_name = loop->do_for_i->var_name };
+    if (expr_reads_symbol(end, loop->do_for_i->var_name) || block_writes_expr(loop->do_for_i->body, end)
+            || block_writes_expr(loop->do_for_i->body, &var)) {
+        return 0;
+    }
+    return end->type == NODE_CONST_INT ? wrap_word(end->number_value) != -1 : loop->do_for_i->end_bounded;
+}
+
+static void effects_of_expr(const ast_node *expr, int *pure, int *terminating) {
+    switch (expr->type) {
+        case NODE_UNARY_OPERATOR:
+            effects_of_expr(node_at(expr->unary_operator.operand), pure, terminating);
+            break;
+        case NODE_BINARY_OPERATOR:
+            if (may_fail_division(expr)) *pure = 0;
+            effects_of_expr(node_at(expr->binary_operator.left), pure, terminating);
+            effects_of_expr(node_at(expr->binary_operator.right), pure, terminating);
+            break;
+        case NODE_CALL: {
+            algorithm *callee = get_algorithm(g_passes.effects_algs, expr->call.function_name);
+            if (!is_alg_pure(callee)) *pure = 0;
+            if (!is_alg_terminating(callee)) *terminating = 0;
+            for (int i = 0; i < expr->call.params_count; ++i) {
+                effects_of_expr(node_at(expr->call.parameters_expr[i]), pure, terminating);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void effects_of_statement(const ast_node *ast, int *pure, int *terminating) {
+    if (ast == NULL) return;
+    switch (ast->type) {
+        case NODE_FUNCTION:
+            effects_of_statement(ast->function.body, pure, terminating);
+            break;
+        case NODE_SEQUENCE:
+            for (int i = 0; i < ast->sequence.count; ++i) {
+                effects_of_statement(ast->sequence.statements[i], pure, terminating);
+            }
+            break;
+        case NODE_ASSIGNEMENT:
+            effects_of_expr(node_at(ast->assignement.expr), pure, terminating);
+            break;
+        case NODE_RETURN:
+            effects_of_expr(node_at(ast->inst_return.expr), pure, terminating);
+            break;
+        case NODE_IF_STATEMENT:
+            effects_of_expr(node_at(ast->if_statement.condition), pure, terminating);
+            effects_of_statement(ast->if_statement.then_block, pure, terminating);
+            effects_of_statement(ast->if_statement.else_block, pure, terminating);
+            break;
+        case NODE_DO_FOR_I:
+            if (!is_bounded_loop(ast)) *terminating = 0;
+            effects_of_expr(node_at(ast->do_for_i->start_expr), pure, terminating);
+            effects_of_expr(node_at(ast->do_for_i->end_expr), pure, terminating);
+            effects_of_statement(ast->do_for_i->body, pure, terminating);
+            break;
+        case NODE_DO_WHILE:
+            *terminating = 0;
+            effects_of_expr(node_at(ast->do_while.condition), pure, terminating);
+            effects_of_statement(ast->do_while.body, pure, terminating);
+            break;
+        case NODE_SPEC_PARAMS_REASSIGN:
+            // Récursion terminale dérécursifiée
+            *terminating = 0;
+            for (int i = 0; i < ast->spec_params_reassign.params_count; ++i) {
+                effects_of_expr(node_at(ast->spec_params_reassign.parameters_expr[i]), pure, terminating);
+            }
+            break;
+        default:
+            ERROR("Unknown statement during effects analysis\n");
+    }
+}
+
+static void effects_of_alg([[ maybe_unused ]] const char *alg_name, algorithm *alg) {
+    int pure = 1;
+    int terminating = 1;
+    effects_of_statement(get_alg_tree(alg), &pure, &terminating);
+    // Pureté : plus grand point fixe (la récursion reste pure)
+    // Terminaison : plus petit point fixe (la récursion ne termine pas)
+    pure = pure && is_alg_pure(alg);
+    terminating = terminating || is_alg_terminating(alg);
+    if (pure != is_alg_pure(alg) || terminating != is_alg_terminating(alg)) {
+        set_alg_effects(alg, pure, terminating);
+        g_effects_changed = 1;
+    }
+}
+
+static void effects_init_alg([[ maybe_unused ]] const char *alg_name, algorithm *alg) {
+    set_alg_effects(alg, 1, 0);
+}
+
+static void effects_print_alg([[ maybe_unused ]] const char *alg_name, algorithm *alg) {
+    printf("Effects of %s: %s, %s\n", get_alg_name(alg),
+        is_alg_pure(alg) ? "pure" : "may print an error",
+        is_alg_terminating(alg) ? "terminating" : "may not terminate");
+}
+
+static void effects_count_alg([[ maybe_unused ]] const char *alg_name, algorithm *alg) {
+    g_effects_changed += is_alg_pure(alg) + is_alg_terminating(alg);
+}
+
+int analyze_effects(algorithms_map *algs, int debug) {
+    g_passes.effects_algs = algs;
+
+    g_effects_changed = 0;
+    foreach_algorithm(algs, effects_count_alg);
+    int previous = g_effects_changed;
+
+    foreach_algorithm(algs, effects_init_alg);
+    // Les appelés d'abord : une seule passe suffit hors récursion
+    do {
+        g_effects_changed = 0;
+        foreach_algorithm_bottom_up(algs, effects_of_alg);
+    } while (g_effects_changed);
+
+    if (debug) foreach_algorithm(algs, effects_print_alg);
+
+    g_effects_changed = 0;
+    foreach_algorithm(algs, effects_count_alg);
+    return g_effects_changed - previous;
+}
+
+
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  ------------------------   Optimisation d'AST   ------------------------  //
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+static _Thread_local int g_odebug = 0;
+static _Thread_local int g_ochanged;
+
+#define O_DEBUGF(fmt, ...) if (g_odebug) { printf("-> " fmt "\n", __VA_ARGS__); }
+#define O_DEBUG(str) O_DEBUGF("%s", str);
+
+#define OC() (g_ochanged++)
+
+#define RIGHT(expr) (node_at((expr)->binary_operator.right))
+#define LEFT(expr) (node_at((expr)->binary_operator.left))
+
+#define IS_INT_CONST(val) ((val)->type == NODE_CONST_INT)
+#define IS_BOOL_CONST(val) ((val)->type == NODE_CONST_BOOL)
+
+#define IS_ZERO(val) (IS_INT_CONST(val) && (val)->number_value == 0)
+#define IS_ONE(val) (IS_INT_CONST(val) && (val)->number_value == 1)
+#define IS_TRUE(val) (IS_BOOL_CONST(val) && (val)->number_value != 0)
+#define IS_FALSE(val) (IS_BOOL_CONST(val) && (val)->number_value == 0)
+
+#define TEST_LEFT_RIGHT(expr, test) (test(node_at((expr)->binary_operator.left)) && test(node_at((expr)->binary_operator.right)))
+
+#define MKVAL(expr, op, make_new) make_new(node_at((expr)->binary_operator.left)->number_value op node_at((expr)->binary_operator.right)->number_value)
+#define MKWORD(expr, op) make_int(wrap_word((long long) node_at((expr)->binary_operator.left)->number_value op (long long) node_at((expr)->binary_operator.right)->number_value))
+
+#define CONCAT_2VAL(expr, op, is_const, mk_new, type_str) if (TEST_LEFT_RIGHT(expr, is_const)) { (expr) = MKVAL(expr, op, mk_new); OC(); O_DEBUG("Precalc " type_str " const expression " #op); break; }
+
+#define CONCAT_2INT(expr, op) if (TEST_LEFT_RIGHT(expr, IS_INT_CONST)) { (expr) = MKWORD(expr, op); OC(); O_DEBUG("Precalc int const expression " #op); break; }
+#define CONCAT_2BOOL(expr, op) CONCAT_2VAL(expr, op, IS_BOOL_CONST, make_bool, "bool");
+// Comme sipro, compare les mots de 16 bits sans signe (uless)
+#define WORD_BITS(val) ((unsigned) wrap_word((val)->number_value) & 0xFFFF)
+#define CONCAT_2INT_RBOOL(expr, op) if (TEST_LEFT_RIGHT(expr, IS_INT_CONST)) { (expr) = make_bool(WORD_BITS(LEFT(expr)) op WORD_BITS(RIGHT(expr))); OC(); O_DEBUG("Precalc bool condition const expression " #op); break; }
+
+#define KEEP_LEFT(expr, condition) if (condition) { (expr) = node_at((expr)->binary_operator.left); OC(); O_DEBUG("Keeping left side of operation"); break; }
+#define KEEP_RIGHT(expr, condition) if (condition) { (expr) = node_at((expr)->binary_operator.right); OC(); O_DEBUG("Keeping right side of operation"); break; }
+
+#define IS_NOT(val) ((val)->type == NODE_UNARY_OPERATOR && (val)->unary_operator.operator == OP_NOT)
+
+#define IS_SYMBOL(val) ((val)->type == NODE_SYMBOL)
+#define ARE_SAME_SYMBOL(s1, s2) (IS_SYMBOL(s1) && IS_SYMBOL(s2) && (s1)->symbol_name == (s2)->symbol_name)
+
+// Les entiers de sipro sont des mots de 16 bits en complément à 2 : les
+// calculs faits à la compilation sont ramenés modulo 2^16 comme sur la cible
+#define WORD_MOD 65536LL
+
+static int wrap_word(long long value) {
+    value %= WORD_MOD;
+    if (value < 0) value += WORD_MOD;
+    return (int) (value >= WORD_MOD / 2 ? value - WORD_MOD : value);
+}
+
+static int same_expr(const ast_node *e1, const ast_node *e2) {
+    if (e1 == e2) return 1;
+    if (e1 == NULL || e2 == NULL || e1->type != e2->type) return 0;
+
+    switch (e1->type) {
+        case NODE_CONST_INT:
+        case NODE_CONST_BOOL:
+            return e1->number_value == e2->number_value;
+        case NODE_SYMBOL:
+            return e1->symbol_name == e2->symbol_name;
+        case NODE_UNARY_OPERATOR:
+            return e1->unary_operator.operator == e2->unary_operator.operator
+                && same_expr(node_at(e1->unary_operator.operand), node_at(e2->unary_operator.operand));
+        case NODE_BINARY_OPERATOR:
+            return e1->binary_operator.operator == e2->binary_operator.operator
+                && same_expr(node_at(e1->binary_operator.left), node_at(e2->binary_operator.left))
+                && same_expr(node_at(e1->binary_operator.right), node_at(e2->binary_operator.right));
+        case NODE_CALL:
+            if (e1->call.function_name != e2->call.function_name
+                || e1->call.params_count != e2->call.params_count) {
+                return 0;
+            }
+            for (int i = 0; i < e1->call.params_count; ++i) {
+                if (!same_expr(node_at(e1->call.parameters_expr[i]), node_at(e2->call.parameters_expr[i]))) return 0;
+            }
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// Copie profonde d'un arbre, pour l'utiliser à plusieurs endroits
+static ast_node *copy_ast(const ast_node *ast) {
+    if (ast == NULL) return NULL;
+    ast_node *copy = cranode();
+    node_id id = copy->id;
+    *copy = *ast;
+    copy->id = id;
+    switch (ast->type) {
+        case NODE_SYMBOL:
+            break;
+        case NODE_UNARY_OPERATOR:
+            copy->unary_operator.operand = id_of(copy_ast(node_at(ast->unary_operator.operand)));
+            break;
+        case NODE_BINARY_OPERATOR:
+            copy->binary_operator.left = id_of(copy_ast(node_at(ast->binary_operator.left)));
+            copy->binary_operator.right = id_of(copy_ast(node_at(ast->binary_operator.right)));
+            break;
+        case NODE_CALL:
+            copy->call.parameters_expr = arena_alloc(g_ast_arena, (size_t) (ast->call.params_count > 0 ? ast->call.params_count : 1) * sizeof *copy->call.parameters_expr);
+            for (int i = 0; i < ast->call.params_count; ++i) {
+                copy->call.parameters_expr[i] = id_of(copy_ast(node_at(ast->call.parameters_expr[i])));
+            }
+            break;
+        case NODE_ASSIGNEMENT:
+            copy->assignement.expr = id_of(copy_ast(node_at(ast->assignement.expr)));
+            break;
+        case NODE_RETURN:
+            copy->inst_return.expr = id_of(copy_ast(node_at(ast->inst_return.expr)));
+            break;
+        case NODE_IF_STATEMENT:
+            copy->if_statement.condition = id_of(copy_ast(node_at(ast->if_statement.condition)));
+            copy->if_statement.then_block = copy_ast(ast->if_statement.then_block);
+            copy->if_statement.else_block = copy_ast(ast->if_statement.else_block);
+            break;
+        case NODE_DO_FOR_I:
+            copy->do_for_i = arena_alloc(g_ast_arena, sizeof *copy->do_for_i);
+            *copy->do_for_i = *ast->do_for_i;
+            copy->do_for_i->start_expr = id_of(copy_ast(node_at(ast->do_for_i->start_expr)));
+            copy->do_for_i->end_expr = id_of(copy_ast(node_at(ast->do_for_i->end_expr)));
+            copy->do_for_i->body = copy_ast(ast->do_for_i->body);
+            break;
+        case NODE_DO_WHILE:
+            copy->do_while.condition = id_of(copy_ast(node_at(ast->do_while.condition)));
+            copy->do_while.body = copy_ast(ast->do_while.body);
+            break;
+        case NODE_SEQUENCE:
+            // La copie est remise à plat : sans NULL ni séquence imbriquée
+            copy->sequence.count = 0;
+            copy->sequence.capacity = ast->sequence.count;
+            copy->sequence.statements = alloc_statements(copy->sequence.capacity);
+            for (int i = 0; i < ast->sequence.count; ++i) {
+                sequence_append(copy, copy_ast(ast->sequence.statements[i]));
+            }
+            break;
+        case NODE_FUNCTION:
+            if (ast->function.memo != NULL) {
+                copy->function.memo = arena_alloc(g_ast_arena, sizeof *copy->function.memo);
+                *copy->function.memo = *ast->function.memo;
+            }
+            copy->function.body = copy_ast(ast->function.body);
+            break;
+        case NODE_SPEC_PARAMS_REASSIGN:
+            copy->spec_params_reassign.parameters_expr = arena_alloc(g_ast_arena, (size_t) (ast->spec_params_reassign.params_count > 0 ? ast->spec_params_reassign.params_count : 1) * sizeof *copy->spec_params_reassign.parameters_expr);
+            for (int i = 0; i < ast->spec_params_reassign.params_count; ++i) {
+                copy->spec_params_reassign.parameters_expr[i] = id_of(copy_ast(node_at(ast->spec_params_reassign.parameters_expr[i])));
+            }
+            break;
+        default:
+            break;
+    }
+    return copy;
+}
+
+// copy_ast alloue chaque nœud avant ses fils : la copie est rangée en préordre,
+//   l'ordre de lecture de toutes les passes. Les nœuds devenus inaccessibles
+//   restent dans l'ancienne arène, libérée en une fois.
+static void compact_alg_tree(algorithms_map *algs, algorithm *alg) {
+    arena *fresh = arena_create(get_algs_arena(algs));
+    arena *previous = set_ast_arena(fresh);
+    associate_tree(alg, copy_ast(get_alg_tree(alg)));
+    set_ast_arena(previous);
+
+    arena *old = replace_alg_arena(alg, fresh);
+    arena_dispose(&old);
+}
+
+static _Thread_local algorithms_map *g_compact_algs;
+
+static void compact_alg_tree_cb([[ maybe_unused ]] const char *alg_name, algorithm *alg) {
+    compact_alg_tree(g_compact_algs, alg);
+}
+
+void compact_ast_trees(algorithms_map *algs) {
+    g_compact_algs = algs;
+    foreach_algorithm(algs, compact_alg_tree_cb);
+    g_compact_algs = NULL;
+}
+
+// Expression sans effet : ne peut pas échouer (division par zéro) et n'appelle
+// que des algorithmes purs qui terminent, elle peut donc être dupliquée,
+// déplacée ou supprimée
+static int is_pure_expr(const ast_node *expr) {
+    switch (expr->type) {
+        case NODE_CONST_INT:
+        case NODE_CONST_BOOL:
+        case NODE_SYMBOL:
+            return 1;
+        case NODE_UNARY_OPERATOR:
+            return is_pure_expr(node_at(expr->unary_operator.operand));
+        case NODE_BINARY_OPERATOR:
+            if (may_fail_division(expr)) {
+                return 0;
+            }
+            return is_pure_expr(LEFT(expr)) && is_pure_expr(RIGHT(expr));
+        case NODE_CALL:
+            if (!call_has_no_effect(expr)) {
+                return 0;
+            }
+            for (int i = 0; i < expr->call.params_count; ++i) {
+                if (!is_pure_expr(node_at(expr->call.parameters_expr[i]))) return 0;
+            }
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static ast_node *make_int_operation(const ast_node *context, ast_node *left, binary_operator_t operator, ast_node *right) {
+    ast_node *node = make_binary_operator(left, operator, right);
+    node->binary_operator.result_type = TYPE_INT;
+    node->line = context->line;
+    return node;
+}
+
+
+//  Réassociation des chaînes + - * : modulo 2^16 l'addition et la
+//    multiplication sont associatives et commutatives, une chaîne est donc mise
+//    à plat, ses constantes sont regroupées en une seule et ses termes opposés
+//    s'annulent. Seuls les termes purs sont fusionnés, l'ordre d'évaluation des
+//    autres est conservé. La division n'est jamais réassociée.
+#define REASSOC_BUF_INIT 8
+
+struct reassoc_term {
+    ast_node *base;
+    int coef;
+};
+
+struct reassoc_chain {
+    struct reassoc_term *terms;
+    int count;
+    int buff_size;
+    int constant;
+};
+
+static void reassoc_push_term(struct reassoc_chain *chain, ast_node *base, int coef) {
+    if (chain->count == chain->buff_size) {
+        chain->buff_size *= 2;
+        chain->terms = realloc(chain->terms, (size_t) chain->buff_size * sizeof *chain->terms);
+        if (chain->terms == NULL) { ERROR("Could not allocate\n"); }
+    }
+    chain->terms[chain->count].base = base;
+    chain->terms[chain->count].coef = coef;
+    chain->count++;
+}
+
+// Ajoute coef * base à la somme, en fusionnant avec un terme pur identique
+static void reassoc_add_term(struct reassoc_chain *chain, ast_node *base, int coef) {
+    if (is_pure_expr(base)) {
+        for (int i = 0; i < chain->count; ++i) {
+            if (is_pure_expr(chain->terms[i].base) && same_expr(chain->terms[i].base, base)) {
+                chain->terms[i].coef = wrap_word((long long) chain->terms[i].coef + coef);
+                return;
+            }
+        }
+    }
+    reassoc_push_term(chain, base, coef);
+}
+
+static void reassoc_collect_sum(struct reassoc_chain *chain, ast_node *expr, int sign) {
+    if (expr->type == NODE_BINARY_OPERATOR && expr->binary_operator.operator == OP_ADD) {
+        reassoc_collect_sum(chain, LEFT(expr), sign);
+        reassoc_collect_sum(chain, RIGHT(expr), sign);
+    } else if (expr->type == NODE_BINARY_OPERATOR && expr->binary_operator.operator == OP_SUB) {
+        reassoc_collect_sum(chain, LEFT(expr), sign);
+        reassoc_collect_sum(chain, RIGHT(expr), -sign);
+    } else if (IS_INT_CONST(expr)) {
+        chain->constant = wrap_word((long long) chain->constant + (long long) sign * expr->number_value);
+    } else if (expr->type == NODE_BINARY_OPERATOR && expr->binary_operator.operator == OP_MUL && IS_INT_CONST(RIGHT(expr))) {
+        reassoc_add_term(chain, LEFT(expr), wrap_word((long long) sign * RIGHT(expr)->number_value));
+    } else if (expr->type == NODE_BINARY_OPERATOR && expr->binary_operator.operator == OP_MUL && IS_INT_CONST(LEFT(expr))) {
+        reassoc_add_term(chain, RIGHT(expr), wrap_word((long long) sign * LEFT(expr)->number_value));
+    } else {
+        reassoc_add_term(chain, expr, sign);
+    }
+}
+
+static void reassoc_collect_product(struct reassoc_chain *chain, ast_node *expr) {
+    if (expr->type == NODE_BINARY_OPERATOR && expr->binary_operator.operator == OP_MUL) {
+        reassoc_collect_product(chain, LEFT(expr));
+        reassoc_collect_product(chain, RIGHT(expr));
+    } else if (IS_INT_CONST(expr)) {
+        chain->constant = wrap_word((long long) chain->constant * expr->number_value);
+    } else {
+        reassoc_push_term(chain, expr, 1);
+    }
+}
+
+static ast_node *reassoc_rebuild_sum(const ast_node *context, struct reassoc_chain *chain) {
+    ast_node *result = NULL;
+    int constant = chain->constant;
+    for (int i = 0; i < chain->count; ++i) {
+        int coef = chain->terms[i].coef;
+        if (coef == 0) continue;
+        int factor = coef > 0 ? coef : wrap_word(-(long long) coef);
+        ast_node *term = factor == 1 ? chain->terms[i].base
+            : make_int_operation(context, chain->terms[i].base, OP_MUL, make_int(factor));
+
+        if (result == NULL && coef > 0) {
+            result = term;
+        } else if (result == NULL) {
+            result = make_int_operation(context, make_int(constant), OP_SUB, term);
+            constant = 0;
+        } else {
+            result = make_int_operation(context, result, coef > 0 ? OP_ADD : OP_SUB, term);
+        }
+    }
+
+    if (result == NULL) return make_int(constant);
+    if (constant > 0 || constant == -WORD_MOD / 2) {
+        result = make_int_operation(context, result, OP_ADD, make_int(constant));
+    } else if (constant < 0) {
+        result = make_int_operation(context, result, OP_SUB, make_int(-constant));
+    }
+    return result;
+}
+
+static ast_node *reassoc_rebuild_product(const ast_node *context, struct reassoc_chain *chain) {
+    if (chain->constant == 0) return make_int(0);
+
+    ast_node *result = NULL;
+    for (int i = 0; i < chain->count; ++i) {
+        result = result == NULL ? chain->terms[i].base
+            : make_int_operation(context, result, OP_MUL, chain->terms[i].base);
+    }
+
+    if (result == NULL) return make_int(chain->constant);
+    if (chain->constant != 1) {
+        result = make_int_operation(context, result, OP_MUL, make_int(chain->constant));
+    }
+    return result;
+}
+
+static void optimize_reassociate(ast_node **expr_ptr) {
+    ast_node *expr = *expr_ptr;
+    struct reassoc_chain chain;
+    chain.terms = cralloc(REASSOC_BUF_INIT * sizeof *chain.terms);
+    chain.buff_size = REASSOC_BUF_INIT;
+    chain.count = 0;
+
+    ast_node *result;
+    if (expr->binary_operator.operator == OP_MUL) {
+        chain.constant = 1;
+        reassoc_collect_product(&chain, expr);
+        result = reassoc_rebuild_product(expr, &chain);
+    } else {
+        chain.constant = 0;
+        reassoc_collect_sum(&chain, expr, 1);
+        result = reassoc_rebuild_sum(expr, &chain);
+    }
+    free(chain.terms);
+
+    // La reconstruction d'une chaîne déjà réassociée redonne la même chaîne
+    if (!same_expr(result, expr)) {
+        *expr_ptr = result;
+        OC(); O_DEBUGF("Reassociated %s chain", b_op_to_str(expr->binary_operator.operator));
+    }
+}
+
+static ast_node *make_bool_operation(const ast_node *context, ast_node *left, binary_operator_t operator, ast_node *right) {
+    ast_node *node = make_binary_operator(left, operator, right);
+    node->binary_operator.result_type = TYPE_BOOL;
+    node->line = context->line;
+    return node;
+}
+
+
+//  Canonicalisation des conditions : un NOT coûte plusieurs instructions
+//    (macro NOT), il est poussé dans les comparaisons (!(a < b) => a >= b) et
+//    à travers && et || (De Morgan) quand cela en retire. && et || évaluent
+//    leurs deux opérandes, De Morgan ne change donc pas l'ordre d'évaluation.
+static int negated_comparison(binary_operator_t operator, binary_operator_t *negated) {
+    switch (operator) {
+        case OP_EQUAL: *negated = OP_NEQUAL; return 1;
+        case OP_NEQUAL: *negated = OP_EQUAL; return 1;
+        case OP_SGT: *negated = OP_ELT; return 1;
+        case OP_ELT: *negated = OP_SGT; return 1;
+        case OP_EGT: *negated = OP_SLT; return 1;
+        case OP_SLT: *negated = OP_EGT; return 1;
+        default: return 0;
+    }
+}
+
+// Opérateur tel que (b op' a) équivaut à (a op b)
+static binary_operator_t swapped_comparison(binary_operator_t operator) {
+    switch (operator) {
+        case OP_SGT: return OP_SLT;
+        case OP_SLT: return OP_SGT;
+        case OP_EGT: return OP_ELT;
+        case OP_ELT: return OP_EGT;
+        default: return operator;
+    }
+}
+
+static int not_count(const ast_node *expr) {
+    switch (expr->type) {
+        case NODE_UNARY_OPERATOR:
+            return (expr->unary_operator.operator == OP_NOT) + not_count(node_at(expr->unary_operator.operand));
+        case NODE_BINARY_OPERATOR:
+            return not_count(LEFT(expr)) + not_count(RIGHT(expr));
+        default:
+            return 0;
+    }
+}
+
+// Renvoie une condition équivalente à !cond, sans modifier cond
+static ast_node *negate_condition(ast_node *cond) {
+    binary_operator_t negated;
+    switch (cond->type) {
+        case NODE_CONST_BOOL:
+            return make_bool(!cond->number_value);
+
+        case NODE_UNARY_OPERATOR:
+            if (cond->unary_operator.operator == OP_NOT) {
+                return node_at(cond->unary_operator.operand);
+            }
+            break;
+
+        case NODE_BINARY_OPERATOR:
+            if (negated_comparison(cond->binary_operator.operator, &negated)) {
+                return make_bool_operation(cond, LEFT(cond), negated, RIGHT(cond));
+            }
+            if (cond->binary_operator.operator == OP_AND || cond->binary_operator.operator == OP_OR) {
+                ast_node *left = negate_condition(LEFT(cond));
+                ast_node *right = negate_condition(RIGHT(cond));
+                if (not_count(left) + not_count(right) < 1 + not_count(cond)) {
+                    return make_bool_operation(cond, left,
+                        cond->binary_operator.operator == OP_AND ? OP_OR : OP_AND, right);
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    ast_node *node = make_unary_operator(OP_NOT, cond);
+    node->unary_operator.result_type = TYPE_BOOL;
+    node->line = cond->line;
+    return node;
+}
+
+// a et b sont des conditions pures dont l'une est la négation de l'autre
+static int are_opposite_conditions(const ast_node *a, const ast_node *b) {
+    if (!is_pure_expr(a) || !is_pure_expr(b)) return 0;
+    if (IS_NOT(a) && same_expr(node_at(a->unary_operator.operand), b)) return 1;
+    if (IS_NOT(b) && same_expr(node_at(b->unary_operator.operand), a)) return 1;
+
+    binary_operator_t negated;
+    return a->type == NODE_BINARY_OPERATOR && b->type == NODE_BINARY_OPERATOR
+        && negated_comparison(a->binary_operator.operator, &negated)
+        && negated == b->binary_operator.operator
+        && same_expr(LEFT(a), LEFT(b)) && same_expr(RIGHT(a), RIGHT(b));
+}
+
+#define FOLD_SAME_OPERANDS(expr, value) if (is_pure_expr(LEFT(expr)) && same_expr(LEFT(expr), RIGHT(expr))) { (expr) = make_bool(value); OC(); O_DEBUG("Precalc comparison of an expression with itself"); break; }
+
+// Réécrit l'expression du slot : les règles remplacent *expr_ptr, rangé dans
+//   le slot à la fin
+static void optimize_expr(node_id *expr_slot) {
+    ast_node *optimized = node_at(*expr_slot);
+    ast_node **expr_ptr = &optimized;
+    ast_node *expr = *expr_ptr;
+
+    switch ((*expr_ptr)->type) {
         case NODE_UNARY_OPERATOR:
             optimize_expr(&((*expr_ptr)->unary_operator.operand));
             
             switch ((*expr_ptr)->unary_operator.operator) {
                 case OP_NOT:
                     // !true => false ; !false => true
-                    if (IS_BOOL_CONST(expr->unary_operator.operand)) {
-                        *expr_ptr = make_bool(!expr->unary_operator.operand->number_value);
+                    if (IS_BOOL_CONST(node_at(expr->unary_operator.operand))) {
+                        *expr_ptr = make_bool(!node_at(expr->unary_operator.operand)->number_value);
                         OC(); O_DEBUG("Precalc bool expression");
                         break;
                     }
 
-                    // !!var => var
-                    if (expr->unary_operator.operand->type == NODE_UNARY_OPERATOR && expr->unary_operator.operand->unary_operator.operator == OP_NOT) {
-                        *expr_ptr = expr->unary_operator.operand->unary_operator.operand;
-                        OC(); O_DEBUG("Precalc bool expression");
-                    }
-                    break;
+                    // !!var => var
+                    if (node_at(expr->unary_operator.operand)->type == NODE_UNARY_OPERATOR && node_at(expr->unary_operator.operand)->unary_operator.operator == OP_NOT) {
+                        *expr_ptr = node_at(node_at(expr->unary_operator.operand)->unary_operator.operand);
+                        OC(); O_DEBUG("Precalc bool expression");
+                        break;
+                    }
+
+                    // !(a < b) => a >= b ; !(a < b && c) => a >= b || !c
+                    ast_node *negated = negate_condition(node_at(expr->unary_operator.operand));
+                    if (not_count(negated) < not_count(expr)) {
+                        *expr_ptr = negated;
+                        OC(); O_DEBUG("Pushed negation into condition");
+                    }
+                    break;
+
+                default: break;
+            }
+             
+            break;
+
+
+        case NODE_BINARY_OPERATOR:
+            optimize_expr(&((*expr_ptr)->binary_operator.left));
+            optimize_expr(&((*expr_ptr)->binary_operator.right));
+            switch ((*expr_ptr)->binary_operator.operator) {
+                case OP_ADD:
+                    // const + const => const
+                    CONCAT_2INT(*expr_ptr, +);
+
+                    // expr + 0 => expr || 0 + expr => expr
+                    KEEP_LEFT(*expr_ptr, IS_ZERO(RIGHT(expr)));
+                    KEEP_RIGHT(*expr_ptr, IS_ZERO(LEFT(expr)));
+
+                    // x + 1 + 2 => x + 3 ; x + y - x => y
+                    optimize_reassociate(expr_ptr);
+                    break;
+
+                case OP_SUB:
+                    // const - const => const
+                    CONCAT_2INT(*expr_ptr, -);
+
+                    // expr - 0 => expr
+                    KEEP_LEFT(*expr_ptr, IS_ZERO(RIGHT(expr)));
+
+                    // var - var => 0
+                    if (ARE_SAME_SYMBOL(LEFT(expr), RIGHT(expr))) {
+                        *expr_ptr = make_int(0);
+                        OC(); O_DEBUG("Precalc expr - expr => 0");
+                        break;
+                    }
+
+                    // (x - 4) + 4 => x
+                    optimize_reassociate(expr_ptr);
+                    break;
+                
+                case OP_MUL:
+                    // const * const => const
+                    CONCAT_2INT(*expr_ptr, *);
+
+                    // expr * 1 => expr || 1 * expr => expr
+                    KEEP_LEFT(*expr_ptr, IS_ONE(RIGHT(expr)));
+                    KEEP_RIGHT(*expr_ptr, IS_ONE(LEFT(expr)));
+
+                    // expr * 0 => 0 || 0 * expr => 0
+                    if (IS_ZERO(LEFT(expr)) || IS_ZERO(RIGHT(expr))) {
+                        *expr_ptr = make_int(0);
+                        OC(); O_DEBUG("Precalc expr * 0 => 0");
+                        break;
+                    }
+
+                    // 2 * x * 3 => x * 6
+                    optimize_reassociate(expr_ptr);
+                    break;
+
+                case OP_DIV:
+                    // expr / 0 => ERROR
+                    if (IS_ZERO(RIGHT(expr))) {
+                        ERRORA(expr, "Division by zero");
+                    }
+
+                    // const / const => const
+                    CONCAT_2INT(*expr_ptr, /);
+
+                    // expr / 1 => expr
+                    KEEP_LEFT(*expr_ptr, IS_ONE(RIGHT(expr)))
+
+                    // var / var => 1
+                    if (ARE_SAME_SYMBOL(LEFT(expr), RIGHT(expr))) {
+                        *expr_ptr = make_int(1);
+                        OC(); O_DEBUG("Precalc expr / expr => 1");
+                        break;
+                    }
+
+                    break;
+
+                case OP_AND:
+                    // const && const => const
+                    CONCAT_2BOOL(*expr_ptr, &&);
+
+                    // expr && true => expr || true && expr => expr
+                    KEEP_LEFT(*expr_ptr, IS_TRUE(RIGHT(expr)))
+                    KEEP_RIGHT(*expr_ptr, IS_TRUE(LEFT(expr)))
+
+                    // expr && false => false || false && expr => false
+                    if (IS_FALSE(LEFT(expr)) || IS_FALSE(RIGHT(expr))) {
+                        *expr_ptr = make_bool(0);
+                        OC(); O_DEBUG("Precalc expr && false => false");
+                        break;
+                    }
+
+                    // expr && expr => expr ; expr && !expr => false
+                    KEEP_LEFT(*expr_ptr, is_pure_expr(LEFT(expr)) && same_expr(LEFT(expr), RIGHT(expr)))
+                    if (are_opposite_conditions(LEFT(expr), RIGHT(expr))) {
+                        *expr_ptr = make_bool(0);
+                        OC(); O_DEBUG("Precalc expr && !expr => false");
+                        break;
+                    }
+
+                    break;
+
+                case OP_OR:
+                    // const || const => const
+                    CONCAT_2BOOL(*expr_ptr, ||);
+
+                    // expr || false => expr || false || expr => expr
+                    KEEP_LEFT(*expr_ptr, IS_FALSE(RIGHT(expr)))
+                    KEEP_RIGHT(*expr_ptr, IS_FALSE(LEFT(expr)))
+
+                    // expr || true => true || true || expr => true
+                    if (IS_TRUE(LEFT(expr)) || IS_TRUE(RIGHT(expr))) {
+                        *expr_ptr = make_bool(1);
+                        OC(); O_DEBUG("Precalc expr || true => true");
+                        break;
+                    }
+
+                    // expr || expr => expr ; expr || !expr => true
+                    KEEP_LEFT(*expr_ptr, is_pure_expr(LEFT(expr)) && same_expr(LEFT(expr), RIGHT(expr)))
+                    if (are_opposite_conditions(LEFT(expr), RIGHT(expr))) {
+                        *expr_ptr = make_bool(1);
+                        OC(); O_DEBUG("Precalc expr || !expr => true");
+                        break;
+                    }
+
+                    break;
+
+                case OP_EQUAL:
+                    // int const == int const => bool const
+                    CONCAT_2INT_RBOOL(*expr_ptr, ==);
+
+                    // expr == expr => true
+                    FOLD_SAME_OPERANDS(*expr_ptr, 1);
+                    break;
+
+                case OP_NEQUAL:
+                    // int const != int const => bool const
+                    CONCAT_2INT_RBOOL(*expr_ptr, !=);
+
+                    // expr != expr => false
+                    FOLD_SAME_OPERANDS(*expr_ptr, 0);
+                    break;
+                
+                case OP_SGT:
+                    // int const > int const => bool const
+                    CONCAT_2INT_RBOOL(*expr_ptr, >);
+
+                    // expr > expr => false
+                    FOLD_SAME_OPERANDS(*expr_ptr, 0);
+                    break;
+
+                case OP_EGT:
+                    // int const >= int const => bool const
+                    CONCAT_2INT_RBOOL(*expr_ptr, >=);
+
+                    // expr >= expr => true
+                    FOLD_SAME_OPERANDS(*expr_ptr, 1);
+                    break;
+
+                case OP_SLT:
+                    // int const < int const => bool const
+                    CONCAT_2INT_RBOOL(*expr_ptr, <);
+
+                    // expr < expr => false
+                    FOLD_SAME_OPERANDS(*expr_ptr, 0);
+                    break;
+
+                case OP_ELT:
+                    // int const <= int const => bool const
+                    CONCAT_2INT_RBOOL(*expr_ptr, <=);
+
+                    // expr <= expr => true
+                    FOLD_SAME_OPERANDS(*expr_ptr, 1);
+                    break;
+
+
+                default: break;
+            }
+            break;
+
+        default:
+            break;
+    }
+    *expr_slot = id_of(optimized);
+}
+
+static void optimize_const_expr(ast_node *ast) {
+    if (ast == NULL) return;
+
+    switch (ast->type) {
+        case NODE_FUNCTION:
+            optimize_const_expr(ast->function.body); break;
+        case NODE_SEQUENCE:
+            for (int i = 0; i < ast->sequence.count; ++i) {
+                optimize_const_expr(ast->sequence.statements[i]);
+            }
+            break;
+        case NODE_ASSIGNEMENT:
+            optimize_expr(&(ast->assignement.expr)); break;
+        case NODE_RETURN:
+            optimize_expr(&(ast->inst_return.expr)); break;
+        case NODE_IF_STATEMENT:
+            optimize_expr(&(ast->if_statement.condition));
+            optimize_const_expr(ast->if_statement.then_block);
+            optimize_const_expr(ast->if_statement.else_block); break;
+        case NODE_DO_FOR_I:
+            optimize_expr(&(ast->do_for_i->start_expr));
+            optimize_expr(&(ast->do_for_i->end_expr));
+            optimize_const_expr(ast->do_for_i->body); break;
+        case NODE_DO_WHILE:
+            optimize_expr(&(ast->do_while.condition));
+            optimize_const_expr(ast->do_while.body); break;
+        default:
+            break;
+    }
+}
+
+static void optimize_dead_blocks(ast_node **ast_ptr) {
+    ast_node *ast = *ast_ptr;
+    if (ast == NULL) return;
+
+    switch (ast->type) {
+        case NODE_FUNCTION:
+            optimize_dead_blocks(&(ast->function.body)); break;
+        case NODE_SEQUENCE: // if return delete after
+            for (int i = 0; i < ast->sequence.count; ++i) {
+                optimize_dead_blocks(&(ast->sequence.statements[i]));
+            }
+            for (int i = 0; i < ast->sequence.count - 1; ++i) {
+                if (check_all_path_returns(ast->sequence.statements[i])) {
+                    // La fin de la sequence ne sera jamais executee
+                    OC(); O_DEBUG("Removing useless code after return statement");
+                    ast->sequence.count = i + 1;
+                    break;
+                }
+            }
+            if (!is_flat_sequence(ast)) {
+                OC(); O_DEBUG("Flattened sequence");
+                ast = make_sequence(ast, NULL);
+                *ast_ptr = ast;
+            }
+            if (ast->sequence.count == 0) {
+                OC(); O_DEBUG("Removed empty sequence");
+                *ast_ptr = NULL;
+            } else if (ast->sequence.count == 1) {
+                OC(); O_DEBUG("Removed single statement sequence");
+                *ast_ptr = ast->sequence.statements[0];
+            }
+            break;
+        
+        case NODE_IF_STATEMENT:
+            optimize_dead_blocks(&(ast->if_statement.then_block));
+            optimize_dead_blocks(&(ast->if_statement.else_block));
+            // Supprime les ifs dont les conditions sont constantes
+            if (IS_BOOL_CONST(node_at(ast->if_statement.condition))) {
+                OC(); O_DEBUG("If statement reduction, condition was bool constant");
+                if (node_at(ast->if_statement.condition)->number_value != 0) { // if (true)
+                    *ast_ptr = ast->if_statement.then_block;
+                } else { // if (false)
+                    *ast_ptr = ast->if_statement.else_block;
+                }
+            }
+
+            // Déplace le block ELSE dans THEN si le block THEN est vide
+            if (ast->if_statement.then_block == NULL && ast->if_statement.else_block != NULL) {
+                OC(); O_DEBUG("If statement switch, THEN block was empty while ELSE wasn't");
+                ast->if_statement.condition = id_of(negate_condition(node_at(ast->if_statement.condition)));
+                ast->if_statement.then_block = ast->if_statement.else_block;
+                ast->if_statement.else_block = NULL;
+            }
+
+            // IF !c A ELSE B => IF c B ELSE A
+            if (*ast_ptr == ast && IS_NOT(node_at(ast->if_statement.condition)) && ast->if_statement.else_block != NULL) {
+                OC(); O_DEBUG("If statement switch, condition was negated");
+                ast_node *then_block = ast->if_statement.then_block;
+                ast->if_statement.condition = id_of(node_at(node_at(ast->if_statement.condition)->unary_operator.operand));
+                ast->if_statement.then_block = ast->if_statement.else_block;
+                ast->if_statement.else_block = then_block;
+            }
+            break;
+
+        case NODE_DO_FOR_I:
+            optimize_dead_blocks(&(ast->do_for_i->body));
+            if (IS_INT_CONST(node_at(ast->do_for_i->start_expr)) && IS_INT_CONST(node_at(ast->do_for_i->end_expr))) {
+                if (node_at(ast->do_for_i->start_expr)->number_value > node_at(ast->do_for_i->end_expr)->number_value) {
+                    // La boucle ne fera aucun tour
+                    OC(); O_DEBUG("Do for statement reduction, no iterations");
+                    *ast_ptr = NULL;
+                }
+            }
+            break;
+
+        case NODE_DO_WHILE:
+            optimize_dead_blocks(&(ast->do_while.body));
+            if (IS_BOOL_CONST(node_at(ast->do_while.condition)) && node_at(ast->do_while.condition)->number_value == 0) {
+                // La boucle ne fera aucun tour
+                OC(); O_DEBUG("While statement reduction, no iterations");
+                *ast_ptr = NULL;
+            }
+            break;
+
+        default: break;
+    }
+}
+
+struct derecursification_information {
+    enum { DR_END, DR_IF_ELSE } dr_type;
+    ast_node *func;
+    union {
+        struct { ast_node **return_s_ptr; } dr_end;
+        struct {
+            ast_node *condition;
+            ast_node *terminate;
+            ast_node **rec_call_body;
+            ast_node **if_ptr;
+            ast_node **return_s_ptr;
+        } dr_if_else;
+    };
+};
+
+static void optimize_tail_call_rebuild_func(const struct derecursification_information *infos) {
+    ast_node *calln;
+    switch (infos->dr_type) {
+        case DR_END:
+            calln = node_at((*infos->dr_end.return_s_ptr)->inst_return.expr);
+            *infos->dr_end.return_s_ptr = NULL;
+            infos->func->function.body = make_do_while(
+                make_bool(1),
+                make_sequence(
+                    infos->func->function.body,
+                    make_spec_params_reassign(calln->call.parameters_expr, calln->call.params_count)
+                )
+            );
+            break;
+        
+        case DR_IF_ELSE:
+            calln = node_at((*infos->dr_if_else.return_s_ptr)->inst_return.expr);
+            *infos->dr_if_else.return_s_ptr = NULL;
+            *infos->dr_if_else.if_ptr = NULL;
+            ast_node *start_body = infos->func->function.body;
+            infos->func->function.body = make_sequence(
+                start_body,
+                make_sequence(   
+                    make_do_while(
+                        negate_condition(infos->dr_if_else.condition),
+                        make_sequence(
+                            make_sequence(
+                                *infos->dr_if_else.rec_call_body,
+                                make_spec_params_reassign(calln->call.parameters_expr, calln->call.params_count)
+                            ),
+                            // Copie : les passes suivantes modifient chaque occurrence selon son contexte
+                            copy_ast(start_body)
+                        )
+                    ),
+                    infos->dr_if_else.terminate
+                )
+            );
+            break;
+
+        default:
+            ERROR("Derecursification informations are invalid\n");
+    }
+}
+
+static int is_recursive_return(const char *alg_name, ast_node *return_s) {
+    if (return_s->type != NODE_RETURN) return 0;
+    if (node_at(return_s->inst_return.expr)->type == NODE_CALL
+        && alg_name == node_at(return_s->inst_return.expr)->call.function_name) {
+            return 1;
+    }
+    return 0;
+}
+
+static ast_node **get_last_instruction(ast_node **ast_ptr) {
+    ast_node *ast = *ast_ptr;
+    
+    if (ast == NULL) return NULL;
+
+    switch (ast->type) {
+        case NODE_SEQUENCE:
+            for (int i = ast->sequence.count - 1; i >= 0; --i) {
+                ast_node **last = get_last_instruction(&(ast->sequence.statements[i]));
+                if (last != NULL) return last;
+            }
+            return NULL;
+
+        default:
+            return ast_ptr;
+    }
+}
+
+// Au premier appel, (*ast_ptr)->type == NODE_FUNCTION
+static struct derecursification_information *optimize_make_drec_infos(const char *alg_name, ast_node **ast_ptr) {
+    ast_node *ast = *ast_ptr;
+    struct derecursification_information *ret;
+
+    if (ast == NULL) {
+        return NULL;
+    }
+
+    switch (ast->type) {
+        case NODE_FUNCTION:
+            struct derecursification_information *result = optimize_make_drec_infos(alg_name, &(ast->function.body));
+            if (result == NULL) {
+                return NULL;
+            }
+            result->func = ast;
+            return result;
+        
+        case NODE_SEQUENCE:
+            // Dernière instruction non supprimée
+            for (int i = ast->sequence.count - 1; i >= 0; --i) {
+                if (ast->sequence.statements[i] != NULL) {
+                    return optimize_make_drec_infos(alg_name, &(ast->sequence.statements[i]));
+                }
+            }
+            return NULL;
+        
+        case NODE_RETURN:
+            if (!is_recursive_return(alg_name, ast)) return NULL;
+            ret = cralloc(sizeof *ret);
+            ret->dr_type = DR_END;
+            ret->dr_end.return_s_ptr = ast_ptr;
+            return ret;
+
+        case NODE_IF_STATEMENT:
+            ret = cralloc(sizeof *ret);
+            ast_node **last_inst = get_last_instruction(&(ast->if_statement.else_block));
+            if (last_inst != NULL && is_recursive_return(alg_name, *last_inst)) {
+                ret->dr_type = DR_IF_ELSE;
+                ret->dr_if_else.condition = node_at(ast->if_statement.condition);
+                ret->dr_if_else.rec_call_body = &(ast->if_statement.else_block);
+                ret->dr_if_else.terminate = ast->if_statement.then_block;
+                ret->dr_if_else.if_ptr = ast_ptr;
+                ret->dr_if_else.return_s_ptr = last_inst;
+                return ret;
+            }
+            last_inst = get_last_instruction(&(ast->if_statement.then_block));
+            if (last_inst != NULL && is_recursive_return(alg_name, *last_inst)) {
+                ret->dr_type = DR_IF_ELSE;
+                ret->dr_if_else.condition = negate_condition(node_at(ast->if_statement.condition));
+                ret->dr_if_else.rec_call_body = &(ast->if_statement.then_block);
+                ret->dr_if_else.terminate = ast->if_statement.else_block;
+                ret->dr_if_else.if_ptr = ast_ptr;
+                ret->dr_if_else.return_s_ptr = last_inst;
+                return ret;
+            }
+            free(ret);
+            return NULL;
+        default:
+            return NULL;
+    }
+}
+
+static void optimize_tail_call_recursion(algorithm *alg, ast_node *ast) {
+    if (ast == NULL || ast->type != NODE_FUNCTION) return;
+
+    struct derecursification_information *infos =
+        optimize_make_drec_infos(get_alg_name(alg), &ast);
+
+    if (infos == NULL) {
+        return;
+    }
+
+    optimize_tail_call_rebuild_func(infos);
+    free(infos);
+
+    OC();
+    O_DEBUGF("Tail call recursion removed for function %s", get_alg_name(alg));
+}
+
+//  Conditions connues le long des chemins : dans le THEN d'un \IF{c}, c est
+//    vraie, dans le ELSE elle est fausse, de même dans le corps d'un DOWHILE
+//    et après lui. Un fait meurt dès qu'une variable qu'il lit est modifiée.
+//    Les comparaisons de sipro étant non signées, les faits de la forme
+//    (x op constante) sont des intervalles de valeurs non signées de x.
+#define MAX_KNOWN_FACTS 32
+
+struct known_fact {
+    const ast_node *condition;
+    int truth;
+};
+
+struct known_facts {
+    struct known_fact facts[MAX_KNOWN_FACTS];
+    int count;
+};
+
+static void facts_add(struct known_facts *known, const ast_node *condition, int truth) {
+    if (condition->type == NODE_BINARY_OPERATOR
+            && ((truth && condition->binary_operator.operator == OP_AND) || (!truth && condition->binary_operator.operator == OP_OR))) {
+        facts_add(known, LEFT(condition), truth);
+        facts_add(known, RIGHT(condition), truth);
+        return;
+    }
+    if (IS_NOT(condition)) {
+        facts_add(known, node_at(condition->unary_operator.operand), !truth);
+        return;
+    }
+    if (!is_pure_expr(condition) || IS_BOOL_CONST(condition)) return;
+    if (known->count == MAX_KNOWN_FACTS) {
+        // Oublie le plus ancien
+        memmove(known->facts, known->facts + 1, (MAX_KNOWN_FACTS - 1) * sizeof *known->facts);
+        known->count--;
+    }
+    known->facts[known->count++] = (struct known_fact) { condition, truth };
+}
+
+// Oublie les faits qui lisent une variable modifiée par le bloc
+static void facts_kill(struct known_facts *known, const ast_node *block) {
+    int kept = 0;
+    for (int i = 0; i < known->count; ++i) {
+        if (!block_writes_expr(block, known->facts[i].condition)) {
+            known->facts[kept++] = known->facts[i];
+        }
+    }
+    known->count = kept;
+}
+
+// (x op c) avec c constant, d'un côté ou de l'autre
+static int split_comparison(const ast_node *cond, const ast_node **x, binary_operator_t *operator, unsigned *c) {
+    if (cond->type != NODE_BINARY_OPERATOR) return 0;
+    binary_operator_t op = cond->binary_operator.operator;
+    if (op != OP_EQUAL && op != OP_NEQUAL && op != OP_SGT && op != OP_EGT && op != OP_SLT && op != OP_ELT) return 0;
+    if (IS_INT_CONST(RIGHT(cond))) {
+        *x = LEFT(cond);
+        *operator = op;
+        *c = (unsigned) wrap_word(RIGHT(cond)->number_value) & 0xFFFF;
+        return 1;
+    }
+    if (IS_INT_CONST(LEFT(cond))) {
+        *x = RIGHT(cond);
+        *operator = swapped_comparison(op);
+        *c = (unsigned) wrap_word(LEFT(cond)->number_value) & 0xFFFF;
+        return 1;
+    }
+    return 0;
+}
+
+// Valeurs non signées [lo, hi] de x telles que (x op c) vaut truth
+static int comparison_interval(binary_operator_t operator, unsigned c, int truth, long *lo, long *hi) {
+    if (!truth && !negated_comparison(operator, &operator)) return 0;
+    switch (operator) {
+        case OP_EQUAL: *lo = c; *hi = c; return 1;
+        case OP_SLT: *lo = 0; *hi = (long) c - 1; return 1;
+        case OP_ELT: *lo = 0; *hi = c; return 1;
+        case OP_SGT: *lo = (long) c + 1; *hi = 0xFFFF; return 1;
+        case OP_EGT: *lo = c; *hi = 0xFFFF; return 1;
+        default: return 0;
+    }
+}
+
+// Renvoie 1 et la valeur de query si un fait la détermine
+static int fact_implies(const struct known_fact *fact, const ast_node *query, int *value) {
+    if (same_expr(fact->condition, query)) {
+        *value = fact->truth;
+        return 1;
+    }
+    if (are_opposite_conditions(fact->condition, query)) {
+        *value = !fact->truth;
+        return 1;
+    }
+
+    const ast_node *fx, *qx;
+    binary_operator_t fop, qop;
+    unsigned fc, qc;
+    long flo, fhi, qlo, qhi;
+    if (!split_comparison(fact->condition, &fx, &fop, &fc) || !split_comparison(query, &qx, &qop, &qc)
+            || !same_expr(fx, qx) || !comparison_interval(fop, fc, fact->truth, &flo, &fhi)) {
+        return 0;
+    }
+    if (qop == OP_NEQUAL) {
+        if ((long) qc < flo || (long) qc > fhi) { *value = 1; return 1; }
+        if (flo == fhi) { *value = 0; return 1; }
+        return 0;
+    }
+    comparison_interval(qop, qc, 1, &qlo, &qhi);
+    if (qlo <= flo && fhi <= qhi) { *value = 1; return 1; }
+    if (fhi < qlo || qhi < flo) { *value = 0; return 1; }
+    return 0;
+}
+
+static void optimize_known_expr(node_id *expr_slot, const struct known_facts *known) {
+    ast_node *expr = node_at(*expr_slot);
+    int value;
+    switch (expr->type) {
+        case NODE_SYMBOL:
+        case NODE_UNARY_OPERATOR:
+        case NODE_BINARY_OPERATOR:
+            if (is_pure_expr(expr)) {
+                for (int i = known->count - 1; i >= 0; --i) {
+                    if (fact_implies(&(known->facts[i]), expr, &value)) {
+                        ast_node *known_value = make_bool(value);
+                        known_value->line = expr->line;
+                        *expr_slot = id_of(known_value);
+                        OC(); O_DEBUG("Condition known from an enclosing condition");
+                        return;
+                    }
+                }
+            }
+            if (expr->type == NODE_UNARY_OPERATOR) {
+                optimize_known_expr(&(expr->unary_operator.operand), known);
+            } else if (expr->type == NODE_BINARY_OPERATOR) {
+                optimize_known_expr(&(expr->binary_operator.left), known);
+                optimize_known_expr(&(expr->binary_operator.right), known);
+            }
+            break;
+        case NODE_CALL:
+            for (int i = 0; i < expr->call.params_count; ++i) {
+                optimize_known_expr(&(expr->call.parameters_expr[i]), known);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void optimize_known_conditions(ast_node *ast, struct known_facts *known) {
+    if (ast == NULL) return;
+
+    struct known_facts other;
+    switch (ast->type) {
+        case NODE_FUNCTION:
+            optimize_known_conditions(ast->function.body, known);
+            break;
+
+        case NODE_SEQUENCE:
+            for (int i = 0; i < ast->sequence.count; ++i) {
+                optimize_known_conditions(ast->sequence.statements[i], known);
+            }
+            break;
+
+        case NODE_ASSIGNEMENT:
+            optimize_known_expr(&(ast->assignement.expr), known);
+            facts_kill(known, ast);
+            break;
+
+        case NODE_RETURN:
+            optimize_known_expr(&(ast->inst_return.expr), known);
+            break;
+
+        case NODE_IF_STATEMENT:
+            optimize_known_expr(&(ast->if_statement.condition), known);
+            other = *known;
+            facts_add(known, node_at(ast->if_statement.condition), 1);
+            facts_add(&other, node_at(ast->if_statement.condition), 0);
+            optimize_known_conditions(ast->if_statement.then_block, known);
+            optimize_known_conditions(ast->if_statement.else_block, &other);
+
+            // Après le IF : seuls les faits vrais à la sortie de chaque
+            //   branche qui ne termine pas la fonction sont gardés
+            int then_returns = check_all_path_returns(ast->if_statement.then_block);
+            int else_returns = check_all_path_returns(ast->if_statement.else_block);
+            if (then_returns && !else_returns) {
+                *known = other;
+            } else if (then_returns == else_returns) {
+                // Intersection : les faits communs aux deux branches
+                int kept = 0;
+                for (int i = 0; i < known->count; ++i) {
+                    for (int j = 0; j < other.count; ++j) {
+                        if (known->facts[i].condition == other.facts[j].condition && known->facts[i].truth == other.facts[j].truth) {
+                            known->facts[kept++] = known->facts[i];
+                            break;
+                        }
+                    }
+                }
+                known->count = kept;
+            }
+            break;
+
+        case NODE_DO_WHILE:
+            facts_kill(known, ast->do_while.body);
+            optimize_known_expr(&(ast->do_while.condition), known);
+            other = *known;
+            facts_add(&other, node_at(ast->do_while.condition), 1);
+            optimize_known_conditions(ast->do_while.body, &other);
+            facts_add(known, node_at(ast->do_while.condition), 0);
+            break;
+
+        case NODE_DO_FOR_I:
+            optimize_known_expr(&(ast->do_for_i->start_expr), known);
+            facts_kill(known, ast);
+            optimize_known_expr(&(ast->do_for_i->end_expr), known);
+            other = *known;
+            optimize_known_conditions(ast->do_for_i->body, &other);
+            break;
+
+        case NODE_SPEC_PARAMS_REASSIGN:
+            for (int i = 0; i < ast->spec_params_reassign.params_count; ++i) {
+                optimize_known_expr(&(ast->spec_params_reassign.parameters_expr[i]), known);
+            }
+            facts_kill(known, ast);
+            break;
+
+        default:
+            ERROR("Unknown statement while propagating known conditions\n");
+    }
+}
+
+void optimize_ast(algorithms_map *algs, ast_node *ast, int debug) {
+    if (ast->type != NODE_FUNCTION) {
+        ERROR("Cannot optimize a non function AST\n");
+    }
+
+    g_odebug = debug;
+    if (debug) printf("Optimize start for function %s\n", ast->function.function_name);
+
+    // Les nœuds créés restent proches de ceux de l'algorithme
+    algorithm *alg = get_algorithm(algs, ast->function.function_name);
+    arena *previous = set_ast_arena(get_alg_arena(alg));
+    
+    do {
+        g_ochanged = 0;
+
+        optimize_const_expr(ast);
+
+        struct known_facts known = { .count = 0 };
+        optimize_known_conditions(ast, &known);
+        
+        optimize_dead_blocks(&ast);
+
+        optimize_tail_call_recursion(alg, ast);
+
+    } while (g_ochanged > 0);
+
+    set_ast_arena(previous);
+    compact_alg_tree(algs, alg);
+
+    if (debug) printf("Optimize end\n\n");
+}
+
+
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  -------------------------   Arguments morts   --------------------------  //
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  Un paramètre qui n'est jamais lu, sinon pour être retransmis à la même
+//    place lors d'un appel récursif, est retiré de l'algorithme et de tous
+//    ses appels. Il en va de même d'un paramètre jamais modifié qui reçoit la
+//    même constante à chaque appel : ses lectures sont remplacées par celle-ci.
+//    Les arguments retirés doivent être des expressions sans effet.
+typedef enum {
+    DA_ANALYZE,
+    DA_REWRITE
+} dead_args_mode;
+
+static _Thread_local struct {
+    dead_args_mode mode;
+    const char *callee;
+    const char *param;
+    int index;
+    int in_callee;
+
+    int reads;          // Lectures autres que les retransmissions
+    int removable;      // Tous les arguments retirés sont sans effet
+    int constant;       // Tous les arguments valent value (NODE_CONST_INT)
+    int sites;
+    int value;
+} g_da;
+
+static _Thread_local algorithm *g_da_callee_alg;
+static _Thread_local int g_da_count;
+
+static void dead_args_walk_expr(node_id *expr_slot);
+
+static void dead_args_site_arg(node_id *arg_slot) {
+    ast_node *arg = node_at(*arg_slot);
+    int passthrough = g_da.in_callee && arg->type == NODE_SYMBOL && arg->symbol_name == g_da.param;
+    if (passthrough || g_da.mode == DA_REWRITE) {
+        return;
+    }
+
+    g_da.sites++;
+    g_da.removable = g_da.removable && is_pure_expr(arg);
+    if (arg->type != NODE_CONST_INT || (g_da.sites > 1 && arg->number_value != g_da.value)) {
+        g_da.constant = 0;
+    } else {
+        g_da.value = arg->number_value;
+    }
+    dead_args_walk_expr(arg_slot);
+}
+
+static void dead_args_walk_args(node_id *args, int *count, int is_site) {
+    for (int i = 0; i < *count; ++i) {
+        if (is_site && i == g_da.index) {
+            dead_args_site_arg(&args[i]);
+        } else {
+            dead_args_walk_expr(&args[i]);
+        }
+    }
+
+    if (is_site && g_da.mode == DA_REWRITE) {
+        for (int i = g_da.index + 1; i < *count; ++i) {
+            args[i - 1] = args[i];
+        }
+        (*count)--;
+    }
+}
+
+// Seul le symbole du paramètre retiré est remplacé, dans son slot
+static void dead_args_walk_expr(node_id *expr_slot) {
+    ast_node *expr = node_at(*expr_slot);
+    switch (expr->type) {
+        case NODE_SYMBOL:
+            if (g_da.in_callee && expr->symbol_name == g_da.param) {
+                if (g_da.mode == DA_ANALYZE) {
+                    g_da.reads++;
+                } else {
+                    ast_node *value = make_int(g_da.value);
+                    set_line(value, get_line(expr));
+                    *expr_slot = id_of(value);
+                }
+            }
+            break;
+        case NODE_UNARY_OPERATOR:
+            dead_args_walk_expr(&expr->unary_operator.operand);
+            break;
+        case NODE_BINARY_OPERATOR:
+            dead_args_walk_expr(&expr->binary_operator.left);
+            dead_args_walk_expr(&expr->binary_operator.right);
+            break;
+        case NODE_CALL:
+            dead_args_walk_args(expr->call.parameters_expr, &expr->call.params_count,
+                expr->call.function_name == g_da.callee);
+            break;
+        default:
+            break;
+    }
+}
+
+static void dead_args_walk(ast_node *ast) {
+    if (ast == NULL) return;
+    switch (ast->type) {
+        case NODE_SPEC_PARAMS_REASSIGN:
+            dead_args_walk_args(ast->spec_params_reassign.parameters_expr, &ast->spec_params_reassign.params_count,
+                g_da.in_callee);
+            break;
+        case NODE_ASSIGNEMENT:
+            dead_args_walk_expr(&ast->assignement.expr);
+            break;
+        case NODE_RETURN:
+            dead_args_walk_expr(&ast->inst_return.expr);
+            break;
+        case NODE_IF_STATEMENT:
+            dead_args_walk_expr(&ast->if_statement.condition);
+            dead_args_walk(ast->if_statement.then_block);
+            dead_args_walk(ast->if_statement.else_block);
+            break;
+        case NODE_DO_FOR_I:
+            dead_args_walk_expr(&ast->do_for_i->start_expr);
+            dead_args_walk_expr(&ast->do_for_i->end_expr);
+            dead_args_walk(ast->do_for_i->body);
+            break;
+        case NODE_DO_WHILE:
+            dead_args_walk_expr(&ast->do_while.condition);
+            dead_args_walk(ast->do_while.body);
+            break;
+        case NODE_FUNCTION:
+            dead_args_walk(ast->function.body);
+            break;
+        case NODE_SEQUENCE:
+            for (int i = 0; i < ast->sequence.count; ++i) {
+                dead_args_walk(ast->sequence.statements[i]);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void dead_args_walk_alg([[ maybe_unused ]] const char *alg_name, algorithm *alg) {
+    g_da.in_callee = alg == g_da_callee_alg;
+    dead_args_walk(get_alg_tree(alg));
+}
+
+static void dead_args_walk_all(algorithms_map *algs, ast_node *main_call, dead_args_mode mode) {
+    g_da.mode = mode;
+    foreach_algorithm(algs, dead_args_walk_alg);
+    g_da.in_callee = 0;
+    node_id main_slot = id_of(main_call);
+    dead_args_walk_expr(&main_slot);
+}
+
+static int eliminate_dead_argument(algorithms_map *algs, ast_node *main_call, algorithm *alg, int index) {
+    variables_map *vars = get_alg_variables(alg);
+    const char *param = get_all_param_names(vars)[index];
+    ast_node *tree = get_alg_tree(alg);
+
+    g_da_callee_alg = alg;
+    g_da.callee = get_alg_name(alg);
+    g_da.param = param;
+    g_da.index = index;
+    g_da.reads = 0;
+    g_da.removable = 1;
+    g_da.constant = 1;
+    g_da.sites = 0;
+    g_da.value = 0;
+    dead_args_walk_all(algs, main_call, DA_ANALYZE);
+
+    ast_node param_symbol = { .type = NODE_SYMBOL, .symbol_name = param };
+    int assigned = block_writes_expr(tree->function.body, &param_symbol);
+    int unused = g_da.reads == 0 && g_da.removable;
+    int constant = !assigned && g_da.constant && g_da.sites > 0;
+    if (!unused && !constant) {
+        return 0;
+    }
+
+    O_DEBUGF("Parameter %s of %s removed%s", param, get_alg_name(alg), unused ? "" : ", replaced by its constant value");
+    dead_args_walk_all(algs, main_call, DA_REWRITE);
+    // Les nœuds qui gardent la variable restent valides
+    if (assigned) {
+        demote_parameter(vars, param);
+    } else {
+        remove_parameter(vars, param);
+    }
+    return 1;
+}
+
+static _Thread_local algorithms_map *g_da_algs;
+static _Thread_local ast_node *g_da_main_call;
+
+static void eliminate_dead_arguments_in_alg([[ maybe_unused ]] const char *alg_name, algorithm *alg) {
+    for (int i = params_count(get_alg_variables(alg)) - 1; i >= 0; --i) {
+        g_da_count += eliminate_dead_argument(g_da_algs, g_da_main_call, alg, i);
+    }
+}
+
+int eliminate_dead_arguments(algorithms_map *algs, ast_node *main_call, int debug) {
+    g_odebug = debug;
+    g_da_algs = algs;
+    g_da_main_call = main_call;
+    g_da_count = 0;
+    int previous;
+    do {
+        previous = g_da_count;
+        foreach_algorithm(algs, eliminate_dead_arguments_in_alg);
+    } while (g_da_count > previous);
+    return g_da_count;
+}
+
+
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  ----------------------   Reconnaissance d'idiomes   --------------------  //
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  Réécrit les formes canoniques écrites à la main :
+//    - puissance par récursion linéaire -> exponentiation rapide
+//    - multiplication par additions répétées -> a * b
+//    - boucle DOFORI qui accumule des fonctions affines du compteur (évolution
+//      scalaire) -> forme close
+//  Les variables cachées contiennent un '#', impossible à écrire en algo.
+static _Thread_local int g_remarks = 0;
+static _Thread_local int g_icount;
+static _Thread_local algorithm *g_icurrent;
+static _Thread_local const ast_node *g_icontext;
+
+#define REMARKF(context_node, fmt, ...) if (g_remarks) { fprintf(stderr, BOLD "Line %d: " RESET "remark: " fmt "\n", get_line(context_node), __VA_ARGS__); }
+
+#define I_SYM(name) make_symbol(name)
+#define I_INT(value) make_int(value)
+#define I_OP(left, op, right) make_int_operation(g_icontext, left, op, right)
+#define I_COND(left, op, right) make_bool_operation(g_icontext, left, op, right)
+#define I_SET(name, expr) idiom_statement(make_assignement(name, expr))
+
+// Sur 16 bits, a^e ne dépend que de e modulo 2^14 dès que e >= 16 : a impair
+//   est d'ordre divisant 2^14 et a pair donne 0. Les exposants négatifs (non
+//   signés >= 2^15) sont ramenés sous 2^15, où la division est exacte.
+#define POW_EXP_REDUCTION 16384
+
+static ast_node *idiom_statement(ast_node *statement) {
+    set_line(statement, get_line(g_icontext));
+    return statement;
+}
+
+static const char *idiom_local(const char *name) {
+    name = intern(name);
+    variables_map *vars = get_alg_variables(g_icurrent);
+    if (!variable_exists(vars, name)) {
+        create_local(vars, name);
+    }
+    return name;
+}
+
+static ast_node *idiom_block(int count, ast_node **statements) {
+    ast_node *block = idiom_statement(make_sequence(NULL, NULL));
+    for (int i = 0; i < count; ++i) {
+        block = append_statement(block, statements[i]);
+    }
+    return block;
+}
+
+static int param_index(const char *symbol) {
+    variables_map *vars = get_alg_variables(g_icurrent);
+    if (!variable_exists(vars, symbol)) return -1;
+    variable *var = get_variable(vars, symbol);
+    return get_variable_semantic(var) == SEM_PARAM ? get_variable_pos(var) : -1;
+}
+
+static int is_symbol_named(const ast_node *expr, const char *name) {
+    return expr->type == NODE_SYMBOL && expr->symbol_name == name;
+}
+
+// Forme reconnue : \IF{b == 0} \RETURN{base} \FI \RETURN{rec} (ou avec \ELSE)
+static int match_countdown(ast_node *body, const char **counter, ast_node **base, ast_node **rec) {
+    ast_node *test, *rest;
+    if (body == NULL) return 0;
+    if (body->type == NODE_SEQUENCE && body->sequence.count == 2
+            && body->sequence.statements[0] != NULL && body->sequence.statements[1] != NULL
+            && body->sequence.statements[0]->type == NODE_IF_STATEMENT
+            && body->sequence.statements[0]->if_statement.else_block == NULL) {
+        test = body->sequence.statements[0];
+        rest = body->sequence.statements[1];
+    } else if (body->type == NODE_IF_STATEMENT && body->if_statement.else_block != NULL) {
+        test = body;
+        rest = body->if_statement.else_block;
+    } else {
+        return 0;
+    }
+
+    ast_node *then_block = test->if_statement.then_block;
+    ast_node *cond = node_at(test->if_statement.condition);
+    if (then_block == NULL || then_block->type != NODE_RETURN || rest->type != NODE_RETURN
+            || cond->type != NODE_BINARY_OPERATOR || cond->binary_operator.operator != OP_EQUAL) {
+        return 0;
+    }
+    ast_node *symbol = IS_ZERO(RIGHT(cond)) ? LEFT(cond) : IS_ZERO(LEFT(cond)) ? RIGHT(cond) : NULL;
+    if (symbol == NULL || symbol->type != NODE_SYMBOL || param_index(symbol->symbol_name) < 0) {
+        return 0;
+    }
+
+    *counter = symbol->symbol_name;
+    *base = node_at(then_block->inst_return.expr);
+    *rec = node_at(rest->inst_return.expr);
+    return 1;
+}
+
+// L'appel récursif décrémente counter, garde les paramètres autres que
+//   changed inchangés, et renvoie l'argument passé à changed
+static int match_countdown_call(const ast_node *call, const char *counter, int changed, ast_node **changed_arg) {
+    const char **pnames = get_all_param_names(get_alg_variables(g_icurrent));
+    if (call->type != NODE_CALL || call->call.function_name != get_alg_name(g_icurrent)) {
+        return 0;
+    }
+    for (int i = 0; i < call->call.params_count; ++i) {
+        ast_node *arg = node_at(call->call.parameters_expr[i]);
+        if (pnames[i] == counter) {
+            if (!(arg->type == NODE_BINARY_OPERATOR && arg->binary_operator.operator == OP_SUB
+                    && is_symbol_named(LEFT(arg), counter) && IS_ONE(RIGHT(arg)))) {
+                return 0;
+            }
+        } else if (i == changed) {
+            *changed_arg = arg;
+        } else if (!is_symbol_named(arg, pnames[i])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// expr est (x op other) ou (other op x) avec op commutatif, renvoie other
+static ast_node *match_commutative(ast_node *expr, binary_operator_t operator, int (*is_x)(const ast_node *, const char *), const char *x) {
+    if (expr->type != NODE_BINARY_OPERATOR || expr->binary_operator.operator != operator) return NULL;
+    if (is_x(LEFT(expr), x)) return RIGHT(expr);
+    if (is_x(RIGHT(expr), x)) return LEFT(expr);
+    return NULL;
+}
+
+static int is_self_call(const ast_node *expr, [[ maybe_unused ]] const char *unused) {
+    return expr->type == NODE_CALL && expr->call.function_name == get_alg_name(g_icurrent);
+}
+
+// Facteur ou terme x invariant : un paramètre autre que le compteur
+static int is_invariant_param(const ast_node *x, const char *counter) {
+    return x != NULL && x->type == NODE_SYMBOL && param_index(x->symbol_name) >= 0 && x->symbol_name != counter;
+}
+
+static ast_node *make_pow_body(ast_node *init, ast_node *base, const char *exponent) {
+    const char *acc = idiom_local("pow#acc");
+    const char *pbase = idiom_local("pow#base");
+    const char *exp = idiom_local("pow#exp");
+
+    ast_node *reduce = idiom_statement(make_do_while(
+        I_COND(I_SYM(exp), OP_SGT, I_INT(32767)),
+        I_SET(exp, I_OP(I_SYM(exp), OP_SUB, I_INT(POW_EXP_REDUCTION)))));
+
+    ast_node *odd = I_COND(I_OP(I_SYM(exp), OP_SUB, I_OP(I_OP(I_SYM(exp), OP_DIV, I_INT(2)), OP_MUL, I_INT(2))), OP_EQUAL, I_INT(1));
+    ast_node *loop_body[] = {
+        idiom_statement(make_if_statement(odd, I_SET(acc, I_OP(I_SYM(acc), OP_MUL, I_SYM(pbase))), NULL)),
+        I_SET(pbase, I_OP(I_SYM(pbase), OP_MUL, I_SYM(pbase))),
+        I_SET(exp, I_OP(I_SYM(exp), OP_DIV, I_INT(2))),
+    };
+    ast_node *square = idiom_statement(make_do_while(I_COND(I_SYM(exp), OP_NEQUAL, I_INT(0)), idiom_block(3, loop_body)));
+
+    ast_node *body[] = {
+        I_SET(acc, init),
+        I_SET(pbase, base),
+        I_SET(exp, I_SYM(exponent)),
+        reduce,
+        square,
+        idiom_statement(make_return(I_SYM(acc))),
+    };
+    return idiom_block(6, body);
+}
+
+// Puissance (base * a^b) ou multiplication (base + a * b), avec ou sans
+//   accumulateur passé en paramètre
+static void recognize_alg_idiom(ast_node *function) {
+    const char *counter;
+    ast_node *base, *rec, *other, *x;
+    if (!match_countdown(function->function.body, &counter, &base, &rec)) return;
+    g_icontext = function;
+
+    int is_pow;
+    ast_node *init;
+    if (base->type == NODE_SYMBOL && param_index(base->symbol_name) >= 0 && base->symbol_name != counter) {
+        // Accumulateur : f(a, b - 1, acc * a) ou f(a, b - 1, acc + a)
+        int acc = param_index(base->symbol_name);
+        if (!match_countdown_call(rec, counter, acc, &other)) return;
+        if ((x = match_commutative(other, OP_MUL, is_symbol_named, base->symbol_name)) != NULL) {
+            is_pow = 1;
+        } else if ((x = match_commutative(other, OP_ADD, is_symbol_named, base->symbol_name)) != NULL) {
+            is_pow = 0;
+        } else {
+            return;
+        }
+        if (x->symbol_name == base->symbol_name) return;
+        init = base;
+    } else {
+        // Récursion directe : a * f(a, b - 1) ou a + f(a, b - 1)
+        if (!is_pure_expr(base) || expr_reads_symbol(base, counter)) return;
+        if ((x = match_commutative(rec, OP_MUL, is_self_call, NULL)) != NULL) {
+            is_pow = 1;
+        } else if ((x = match_commutative(rec, OP_ADD, is_self_call, NULL)) != NULL) {
+            is_pow = 0;
+        } else {
+            return;
+        }
+        other = is_self_call(LEFT(rec), NULL) ? LEFT(rec) : RIGHT(rec);
+        if (!match_countdown_call(other, counter, -1, NULL)) return;
+        init = base;
+    }
+    if (!is_invariant_param(x, counter)) return;
+
+    if (is_pow) {
+        function->function.body = make_pow_body(init, x, counter);
+        REMARKF(function, "'%s' computes a power by linear recursion, rewritten as exponentiation by squaring", function->function.function_name);
+    } else {
+        function->function.body = idiom_statement(make_return(I_OP(init, OP_ADD, I_OP(x, OP_MUL, I_SYM(counter)))));
+        REMARKF(function, "'%s' multiplies by repeated addition, rewritten as a multiplication", function->function.function_name);
+    }
+    O_DEBUGF("Idiom recognized in %s", function->function.function_name);
+    g_icount++;
+}
+
+//  Evolution scalaire des boucles DOFORI dont le corps ne fait qu'accumuler
+//    des fonctions affines du compteur : \SET{k}{k + c * i + d}, avec c et d
+//    invariants. Avec n = end - i + 1 itérations et S = n * i + n(n - 1) / 2
+//    la somme des valeurs du compteur, k vaut en sortie k + c * S + d * n.
+//    La moitié de n (non signé) est calculée exactement puis multipliée par
+//    le facteur restant, pour que S soit juste modulo 2^16.
+//  Les accumulations polynomiales (c * i * i, ...) ne sont pas traitées :
+//    leurs formes closes restent exactes sur 16 bits en divisant chaque
+//    facteur par 2 ou 3 avant le produit, mais leur reconnaissance dépasse
+//    cette passe, limitée aux fonctions affines.
+#define SCEV_MAX_ACCUMULATORS 16
+
+struct scev_accumulator {
+    const char *var_name;
+    ast_node *coef;         // c, NULL si nul
+    ast_node *constant;     // d, NULL si nul
+};
+
+struct scev_loop {
+    const char *counter;
+    struct scev_accumulator accs[SCEV_MAX_ACCUMULATORS];
+    int count;
+};
+
+static ast_node *scev_add(ast_node *left, binary_operator_t operator, ast_node *right) {
+    if (right == NULL) return left;
+    if (left == NULL) return operator == OP_ADD ? right : I_OP(I_INT(0), OP_SUB, right);
+    return I_OP(left, operator, right);
+}
+
+static ast_node *scev_mul(ast_node *factor, ast_node *value) {
+    return value == NULL ? NULL : I_OP(factor, OP_MUL, value);
+}
+
+// Expression qui ne change pas pendant la boucle
+static int scev_invariant(const ast_node *expr, const struct scev_loop *loop) {
+    if (!is_pure_expr(expr) || expr_reads_symbol(expr, loop->counter)) return 0;
+    for (int i = 0; i < loop->count; ++i) {
+        if (expr_reads_symbol(expr, loop->accs[i].var_name)) return 0;
+    }
+    return 1;
+}
+
+// Décompose expr en coef * compteur + constant
+static int scev_affine(ast_node *expr, const struct scev_loop *loop, ast_node **coef, ast_node **constant) {
+    ast_node *c1, *d1, *c2, *d2;
+    if (is_symbol_named(expr, loop->counter)) {
+        *coef = I_INT(1);
+        *constant = NULL;
+        return 1;
+    }
+    if (scev_invariant(expr, loop)) {
+        *coef = NULL;
+        *constant = expr;
+        return 1;
+    }
+    if (expr->type != NODE_BINARY_OPERATOR) return 0;
+
+    switch (expr->binary_operator.operator) {
+        case OP_ADD:
+        case OP_SUB:
+            if (!scev_affine(LEFT(expr), loop, &c1, &d1) || !scev_affine(RIGHT(expr), loop, &c2, &d2)) return 0;
+            *coef = scev_add(c1, expr->binary_operator.operator, c2);
+            *constant = scev_add(d1, expr->binary_operator.operator, d2);
+            return 1;
+        case OP_MUL:
+            if (scev_invariant(LEFT(expr), loop) && scev_affine(RIGHT(expr), loop, &c2, &d2)) {
+                *coef = scev_mul(LEFT(expr), c2);
+                *constant = scev_mul(LEFT(expr), d2);
+                return 1;
+            }
+            if (scev_invariant(RIGHT(expr), loop) && scev_affine(LEFT(expr), loop, &c1, &d1)) {
+                *coef = scev_mul(RIGHT(expr), c1);
+                *constant = scev_mul(RIGHT(expr), d1);
+                return 1;
+            }
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+// Relève les accumulateurs du corps : que des \SET{k}{k + e}, e affine
+static int scev_collect(const ast_node *body, struct scev_loop *loop) {
+    if (body == NULL) return 1;
+    if (body->type == NODE_SEQUENCE) {
+        for (int i = 0; i < body->sequence.count; ++i) {
+            if (!scev_collect(body->sequence.statements[i], loop)) return 0;
+        }
+        return 1;
+    }
+    if (body->type != NODE_ASSIGNEMENT || loop->count >= SCEV_MAX_ACCUMULATORS) return 0;
+
+    const char *var_name = body->assignement.var_name;
+    if (var_name == loop->counter) return 0;
+    for (int i = 0; i < loop->count; ++i) {
+        if (loop->accs[i].var_name == var_name) return 0;
+    }
+    loop->accs[loop->count++] = (struct scev_accumulator) { var_name, NULL, NULL };
+    return 1;
+}
+
+// Retire l'accumulateur d'une somme où il apparaît avec le signe +
+static int scev_split(ast_node *expr, const char *acc, ast_node **increment) {
+    ast_node *rest;
+    if (is_symbol_named(expr, acc)) {
+        *increment = NULL;
+        return 1;
+    }
+    if (expr->type != NODE_BINARY_OPERATOR) return 0;
+    switch (expr->binary_operator.operator) {
+        case OP_ADD:
+            if (scev_split(LEFT(expr), acc, &rest)) {
+                *increment = scev_add(rest, OP_ADD, RIGHT(expr));
+                return 1;
+            }
+            if (scev_split(RIGHT(expr), acc, &rest)) {
+                *increment = scev_add(LEFT(expr), OP_ADD, rest);
+                return 1;
+            }
+            return 0;
+        case OP_SUB:
+            if (scev_split(LEFT(expr), acc, &rest)) {
+                *increment = scev_add(rest, OP_SUB, RIGHT(expr));
+                return 1;
+            }
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+static int scev_increment(const ast_node *assignement, struct scev_loop *loop, struct scev_accumulator *acc) {
+    ast_node *increment;
+    if (!scev_split(node_at(assignement->assignement.expr), acc->var_name, &increment)) return 0;
+    if (increment == NULL) return 1;
+    return scev_affine(increment, loop, &(acc->coef), &(acc->constant));
+}
 
-                default: break;
+static int scev_increments(const ast_node *body, struct scev_loop *loop, int *index) {
+    if (body == NULL) return 1;
+    if (body->type == NODE_SEQUENCE) {
+        for (int i = 0; i < body->sequence.count; ++i) {
+            if (!scev_increments(body->sequence.statements[i], loop, index)) return 0;
+        }
+        return 1;
+    }
+    int i = (*index)++;
+    return scev_increment(body, loop, &(loop->accs[i]));
+}
+
+static ast_node *make_scev_closed_form(ast_node *loop_node, struct scev_loop *loop) {
+    const char *i = loop->counter;
+    const char *end = idiom_local("scev#end");
+    const char *count = idiom_local("scev#count");
+    const char *half = idiom_local("scev#half");
+    const char *sum = idiom_local("scev#sum");
+
+    // Borne 0xFFFF : la boucle ne termine pas, on la garde telle quelle
+    ast_node *kept = idiom_statement(make_do_for_i(i, I_SYM(i), I_SYM(end), loop_node->do_for_i->body));
+
+    ast_node *halving = idiom_statement(make_if_statement(
+        I_COND(I_SYM(count), OP_ELT, I_INT(32767)),
+        I_SET(half, I_OP(I_SYM(count), OP_DIV, I_INT(2))),
+        I_SET(half, I_OP(I_OP(I_OP(I_OP(I_SYM(count), OP_SUB, I_INT(16384)), OP_SUB, I_INT(16384)), OP_DIV, I_INT(2)), OP_ADD, I_INT(16384)))));
+    ast_node *triangle = I_OP(I_SYM(half), OP_MUL,
+        I_OP(I_OP(I_OP(I_INT(2), OP_MUL, I_SYM(count)), OP_SUB, I_INT(1)), OP_SUB, I_OP(I_INT(2), OP_MUL, I_SYM(half))));
+
+    ast_node *closed[SCEV_MAX_ACCUMULATORS + 4] = {
+        I_SET(count, I_OP(I_OP(I_SYM(end), OP_SUB, I_SYM(i)), OP_ADD, I_INT(1))),
+        halving,
+        I_SET(sum, I_OP(I_OP(I_SYM(count), OP_MUL, I_SYM(i)), OP_ADD, triangle)),
+    };
+    int closed_count = 3;
+    for (int k = 0; k < loop->count; ++k) {
+        struct scev_accumulator *acc = &(loop->accs[k]);
+        ast_node *value = I_SYM(acc->var_name);
+        // Le corps est gardé pour la borne 0xFFFF : copie de ses expressions
+        value = scev_add(value, OP_ADD, scev_mul(I_SYM(sum), copy_ast(acc->coef)));
+        value = scev_add(value, OP_ADD, scev_mul(I_SYM(count), copy_ast(acc->constant)));
+        closed[closed_count++] = I_SET(acc->var_name, value);
+    }
+    closed[closed_count++] = I_SET(i, I_OP(I_SYM(end), OP_ADD, I_INT(1)));
+    ast_node *run = idiom_statement(make_if_statement(I_COND(I_SYM(i), OP_ELT, I_SYM(end)), idiom_block(closed_count, closed), NULL));
+
+    ast_node *statements[] = {
+        I_SET(idiom_local(i), node_at(loop_node->do_for_i->start_expr)),
+        I_SET(end, node_at(loop_node->do_for_i->end_expr)),
+        idiom_statement(make_if_statement(I_COND(I_SYM(end), OP_EQUAL, I_INT(-1)), kept, run)),
+    };
+    return idiom_block(3, statements);
+}
+
+static void recognize_loop_idiom(ast_node **loop_ptr) {
+    ast_node *loop_node = *loop_ptr;
+    struct scev_loop loop = { .counter = loop_node->do_for_i->var_name, .count = 0 };
+    int index = 0;
+
+    g_icontext = loop_node;
+    if (!scev_collect(loop_node->do_for_i->body, &loop) || !scev_increments(loop_node->do_for_i->body, &loop, &index)) return;
+    if (!scev_invariant(node_at(loop_node->do_for_i->end_expr), &loop)) return;
+
+    *loop_ptr = make_scev_closed_form(loop_node, &loop);
+    if (loop.count == 0) {
+        REMARKF(loop_node, "%s", "empty loop replaced by the final value of its counter");
+    } else {
+        REMARKF(loop_node, "loop only accumulates affine functions of '%s', replaced by its closed form", loop.counter);
+    }
+    O_DEBUGF("Loop on %s replaced by its closed form", loop.counter);
+    g_icount++;
+}
+
+static void recognize_statement_idioms(ast_node **ast_ptr) {
+    ast_node *ast = *ast_ptr;
+    if (ast == NULL) return;
+    switch (ast->type) {
+        case NODE_FUNCTION:
+            recognize_statement_idioms(&(ast->function.body));
+            break;
+        case NODE_SEQUENCE:
+            for (int i = 0; i < ast->sequence.count; ++i) {
+                recognize_statement_idioms(&(ast->sequence.statements[i]));
             }
-             
             break;
+        case NODE_IF_STATEMENT:
+            recognize_statement_idioms(&(ast->if_statement.then_block));
+            recognize_statement_idioms(&(ast->if_statement.else_block));
+            break;
+        case NODE_DO_WHILE:
+            recognize_statement_idioms(&(ast->do_while.body));
+            break;
+        case NODE_DO_FOR_I:
+            recognize_statement_idioms(&(ast->do_for_i->body));
+            recognize_loop_idiom(ast_ptr);
+            break;
+        default:
+            break;
+    }
+}
 
+static void recognize_idioms_in_alg([[ maybe_unused ]] const char *alg_name, algorithm *alg) {
+    ast_node *tree = get_alg_tree(alg);
+    g_icurrent = alg;
+    arena *previous = set_ast_arena(get_alg_arena(alg));
+    recognize_alg_idiom(tree);
+    recognize_statement_idioms(&tree);
+    set_ast_arena(previous);
+    g_icurrent = NULL;
+}
 
-        case NODE_BINARY_OPERATOR:
-            optimize_expr(&((*expr_ptr)->binary_operator.left));
-            optimize_expr(&((*expr_ptr)->binary_operator.right));
-            switch ((*expr_ptr)->binary_operator.operator) {
-                case OP_ADD:
-                    // const + const => const
-                    CONCAT_2INT(*expr_ptr, +);
+int recognize_idioms(algorithms_map *algs, int debug, int remarks) {
+    g_odebug = debug;
+    g_remarks = remarks;
+    g_icount = 0;
+    foreach_algorithm(algs, recognize_idioms_in_alg);
+    return g_icount;
+}
 
-                    // expr + 0 => expr || 0 + expr => expr
-                    KEEP_LEFT(*expr_ptr, IS_ZERO(RIGHT(expr)));
-                    KEEP_RIGHT(*expr_ptr, IS_ZERO(LEFT(expr)));
-                    break;
 
-                case OP_SUB:
-                    // const - const => const
-                    CONCAT_2INT(*expr_ptr, -);
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  ------------------------   Intervalles de valeurs   --------------------  //
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  Analyse par intervalles des variables locales, des paramètres (union des
+//    valeurs reçues à tous les sites d'appel) et des valeurs de retour. Elle
+//    sert à retirer la vérification de division par zéro et à précalculer les
+//    comparaisons dont le résultat ne dépend pas des valeurs.
+//  Les comparaisons d'ordre de sipro sont non signées (uless) : elles ne sont
+//    précalculées et n'affinent les intervalles que lorsque l'ordre non signé
+//    et l'ordre signé coïncident.
+#define WORD_MIN ((int) (-WORD_MOD / 2))
+#define WORD_MAX ((int) (WORD_MOD / 2 - 1))
+
+#define RANGE_WIDEN_AFTER 16        // Mises à jour avant élargissement
+#define RANGE_NARROW_ROUNDS 2       // Passes de rétrécissement après point fixe
+
+typedef struct { int lo; int hi; } value_range;
+
+#define RANGE_EMPTY ((value_range) { 1, 0 })
+#define RANGE_FULL ((value_range) { WORD_MIN, WORD_MAX })
+#define RANGE_BOOL ((value_range) { 0, 1 })
+#define RANGE_CONST(v) ((value_range) { (v), (v) })
+
+#define IS_EMPTY_RANGE(r) ((r).lo > (r).hi)
+#define IS_SINGLE_RANGE(r) ((r).lo == (r).hi)
+#define SAME_RANGE(r1, r2) (((r1).lo == (r2).lo && (r1).hi == (r2).hi) || (IS_EMPTY_RANGE(r1) && IS_EMPTY_RANGE(r2)))
+#define HAS_ZERO(r) ((r).lo <= 0 && 0 <= (r).hi)
+// Ordres signé et non signé identiques sur une même moitié des mots
+#define SAME_HALF(r1, r2) (((r1).lo >= 0 && (r2).lo >= 0) || ((r1).hi < 0 && (r2).hi < 0))
+
+typedef struct {
+    value_range *vars;      // Paramètres puis variables locales
+    int count;
+    int reachable;
+} range_env;
+
+struct alg_ranges {
+    int called;             // Au moins un site d'appel analysé
+    value_range *params;
+    value_range ret;
+    int updates;            // Nombre d'agrandissements (élargissement)
+    value_range *next_params;
+    value_range next_ret;
+};
 
-                    // expr - 0 => expr
-                    KEEP_LEFT(*expr_ptr, IS_ZERO(RIGHT(expr)));
+static _Thread_local algorithms_map *g_ralgs;
+static _Thread_local algorithm *g_rcurrent;
+static _Thread_local int g_rapply;                // Marque les divisions / précalcule
+static _Thread_local int g_rnarrowing;            // Collecte dans next_params et next_ret
+static _Thread_local int g_rchanged;
+static _Thread_local int g_rfolded;
 
-                    // var - var => 0
-                    if (ARE_SAME_SYMBOL(LEFT(expr), RIGHT(expr))) {
-                        *expr_ptr = make_int(0);
-                        OC(); O_DEBUG("Precalc expr - expr => 0");
-                        break;
-                    }
+static value_range range_of_expr(node_id *expr_slot, range_env *env);
 
-                    break;
-                
-                case OP_MUL:
-                    // const * const => const
-                    CONCAT_2INT(*expr_ptr, *);
+static value_range range_make(long long lo, long long hi) {
+    if (lo < WORD_MIN || hi > WORD_MAX) {
+        // Dépassement : la valeur peut boucler n'importe où
+        return RANGE_FULL;
+    }
+    return (value_range) { (int) lo, (int) hi };
+}
 
-                    // expr * 1 => expr || 1 * expr => expr
-                    KEEP_LEFT(*expr_ptr, IS_ONE(RIGHT(expr)));
-                    KEEP_RIGHT(*expr_ptr, IS_ONE(LEFT(expr)));
+static value_range range_join(value_range r1, value_range r2) {
+    if (IS_EMPTY_RANGE(r1)) return r2;
+    if (IS_EMPTY_RANGE(r2)) return r1;
+    return (value_range) { r1.lo < r2.lo ? r1.lo : r2.lo, r1.hi > r2.hi ? r1.hi : r2.hi };
+}
 
-                    // expr * 0 => 0 || 0 * expr => 0
-                    if (IS_ZERO(LEFT(expr)) || IS_ZERO(RIGHT(expr))) {
-                        *expr_ptr = make_int(0);
-                        OC(); O_DEBUG("Precalc expr * 0 => 0");
-                        break;
-                    }
+static value_range range_meet(value_range r1, value_range r2) {
+    return (value_range) { r1.lo > r2.lo ? r1.lo : r2.lo, r1.hi < r2.hi ? r1.hi : r2.hi };
+}
 
-                    break;
+// Elargissement à seuils (0 puis les bornes des mots) pour garder le signe
+static value_range range_widen(value_range old, value_range new) {
+    if (IS_EMPTY_RANGE(old)) return new;
+    value_range r = range_join(old, new);
+    if (r.lo < old.lo) r.lo = r.lo >= 0 ? 0 : WORD_MIN;
+    if (r.hi > old.hi) r.hi = r.hi <= -1 ? -1 : WORD_MAX;
+    return r;
+}
 
-                case OP_DIV:
-                    // const / const => const
-                    CONCAT_2INT(*expr_ptr, /);
+static value_range range_arith(binary_operator_t operator, value_range r1, value_range r2) {
+    if (IS_EMPTY_RANGE(r1) || IS_EMPTY_RANGE(r2)) return RANGE_EMPTY;
+
+    switch (operator) {
+        case OP_ADD: return range_make((long long) r1.lo + r2.lo, (long long) r1.hi + r2.hi);
+        case OP_SUB: return range_make((long long) r1.lo - r2.hi, (long long) r1.hi - r2.lo);
+        case OP_MUL: {
+            long long c[4] = {
+                (long long) r1.lo * r2.lo, (long long) r1.lo * r2.hi,
+                (long long) r1.hi * r2.lo, (long long) r1.hi * r2.hi
+            };
+            long long lo = c[0], hi = c[0];
+            for (int i = 1; i < 4; ++i) {
+                if (c[i] < lo) lo = c[i];
+                if (c[i] > hi) hi = c[i];
+            }
+            return range_make(lo, hi);
+        }
+        case OP_DIV:
+            // La division de sipro n'est connue que sur les valeurs positives
+            if (r1.lo < 0 || r2.lo < 0) return RANGE_FULL;
+            if (r2.hi == 0) return RANGE_EMPTY;
+            return (value_range) { r1.lo / r2.hi, r1.hi / (r2.lo == 0 ? 1 : r2.lo) };
+        default:
+            return RANGE_FULL;
+    }
+}
 
-                    // expr / 1 => expr
-                    KEEP_LEFT(*expr_ptr, IS_ONE(RIGHT(expr)))
+// Renvoie 1 et affecte *result si la comparaison est toujours vraie ou fausse
+static int range_compare(binary_operator_t operator, value_range r1, value_range r2, int *result) {
+    if (IS_EMPTY_RANGE(r1) || IS_EMPTY_RANGE(r2)) return 0;
 
-                    // expr / 0 => ERROR
-                    if (IS_ZERO(RIGHT(expr))) {
-                        ERRORA(expr, "Division by zero");
-                    }
+    switch (operator) {
+        case OP_EQUAL:
+        case OP_NEQUAL:
+            if (IS_SINGLE_RANGE(r1) && SAME_RANGE(r1, r2)) {
+                *result = operator == OP_EQUAL;
+                return 1;
+            }
+            if (r1.hi < r2.lo || r2.hi < r1.lo) {
+                *result = operator == OP_NEQUAL;
+                return 1;
+            }
+            return 0;
+        case OP_SGT: return range_compare(OP_SLT, r2, r1, result);
+        case OP_EGT: return range_compare(OP_ELT, r2, r1, result);
+        case OP_SLT:
+        case OP_ELT:
+            if (!SAME_HALF(r1, r2)) return 0;
+            if (operator == OP_SLT ? r1.hi < r2.lo : r1.hi <= r2.lo) { *result = 1; return 1; }
+            if (operator == OP_SLT ? r1.lo >= r2.hi : r1.lo > r2.hi) { *result = 0; return 1; }
+            return 0;
+        default:
+            return 0;
+    }
+}
 
-                    // var / var => 1
-                    if (ARE_SAME_SYMBOL(LEFT(expr), RIGHT(expr))) {
-                        *expr_ptr = make_int(1);
-                        OC(); O_DEBUG("Precalc expr / expr => 1");
-                        break;
-                    }
+static range_env *range_env_create(int count) {
+    range_env *env = cralloc(sizeof *env);
+    env->vars = cralloc((size_t) (count > 0 ? count : 1) * sizeof *env->vars);
+    env->count = count;
+    env->reachable = 1;
+    for (int i = 0; i < count; ++i) {
+        env->vars[i] = RANGE_EMPTY;
+    }
+    return env;
+}
 
-                    break;
+static range_env *range_env_copy(const range_env *src) {
+    range_env *env = range_env_create(src->count);
+    memcpy(env->vars, src->vars, (size_t) src->count * sizeof *env->vars);
+    env->reachable = src->reachable;
+    return env;
+}
 
-                case OP_AND:
-                    // const && const => const
-                    CONCAT_2BOOL(*expr_ptr, &&);
+static void range_env_dispose(range_env *env) {
+    free(env->vars);
+    free(env);
+}
 
-                    // expr && true => expr || true && expr => expr
-                    KEEP_LEFT(*expr_ptr, IS_TRUE(RIGHT(expr)))
-                    KEEP_RIGHT(*expr_ptr, IS_TRUE(LEFT(expr)))
+static void range_env_assign(range_env *dest, const range_env *src) {
+    memcpy(dest->vars, src->vars, (size_t) src->count * sizeof *dest->vars);
+    dest->reachable = src->reachable;
+}
 
-                    // expr && false => false || false && expr => false
-                    if (IS_FALSE(LEFT(expr)) || IS_FALSE(RIGHT(expr))) {
-                        *expr_ptr = make_bool(0);
-                        OC(); O_DEBUG("Precalc expr && false => false");
-                        break;
-                    }
+static void range_env_join(range_env *dest, const range_env *src) {
+    if (!src->reachable) return;
+    if (!dest->reachable) {
+        range_env_assign(dest, src);
+        return;
+    }
+    for (int i = 0; i < dest->count; ++i) {
+        dest->vars[i] = range_join(dest->vars[i], src->vars[i]);
+    }
+}
 
-                    break;
+static int range_env_equal(const range_env *e1, const range_env *e2) {
+    if (e1->reachable != e2->reachable) return 0;
+    if (!e1->reachable) return 1;
+    for (int i = 0; i < e1->count; ++i) {
+        if (!SAME_RANGE(e1->vars[i], e2->vars[i])) return 0;
+    }
+    return 1;
+}
 
-                case OP_OR:
-                    // const || const => const
-                    CONCAT_2BOOL(*expr_ptr, ||);
+static void range_env_widen(range_env *dest, const range_env *src) {
+    if (!src->reachable) return;
+    if (!dest->reachable) {
+        range_env_assign(dest, src);
+        return;
+    }
+    for (int i = 0; i < dest->count; ++i) {
+        dest->vars[i] = range_widen(dest->vars[i], src->vars[i]);
+    }
+}
 
-                    // expr || false => expr || false || expr => expr
-                    KEEP_LEFT(*expr_ptr, IS_FALSE(RIGHT(expr)))
-                    KEEP_RIGHT(*expr_ptr, IS_FALSE(LEFT(expr)))
+// node : symbole, assignation ou DOFORI
+static int range_slot(ast_node *node) {
+    variables_map *vars = get_alg_variables(g_rcurrent);
+    return get_variable_id(vars, node_variable(node, vars));
+}
 
-                    // expr || true => true || true || expr => true
-                    if (IS_TRUE(LEFT(expr)) || IS_TRUE(RIGHT(expr))) {
-                        *expr_ptr = make_bool(1);
-                        OC(); O_DEBUG("Precalc expr || true => true");
-                        break;
-                    }
+static struct alg_ranges *get_alg_ranges(const char *alg_name) {
+    struct alg_ranges *r = hashtable_search(g_passes.ranges, alg_name);
+    if (r == NULL) {
+        algorithm *alg = get_algorithm(g_ralgs, alg_name);
+        int pcount = params_count(get_alg_variables(alg));
+        r = cralloc(sizeof *r);
+        r->called = 0;
+        r->params = cralloc((size_t) (pcount > 0 ? pcount : 1) * sizeof *r->params);
+        r->next_params = cralloc((size_t) (pcount > 0 ? pcount : 1) * sizeof *r->next_params);
+        for (int i = 0; i < pcount; ++i) {
+            r->params[i] = RANGE_EMPTY;
+            r->next_params[i] = RANGE_EMPTY;
+        }
+        r->ret = RANGE_EMPTY;
+        r->next_ret = RANGE_EMPTY;
+        r->updates = 0;
+        hashtable_add(g_passes.ranges, get_alg_name(alg), r);
+    }
+    return r;
+}
 
-                    break;
+static void range_update(struct alg_ranges *r, value_range *dest, value_range *next, value_range value) {
+    if (g_rnarrowing) {
+        *next = range_join(*next, value);
+        return;
+    }
+    value_range joined = range_join(*dest, value);
+    if (!SAME_RANGE(joined, *dest)) {
+        *dest = ++r->updates > RANGE_WIDEN_AFTER ? range_widen(*dest, joined) : joined;
+        g_rchanged = 1;
+    }
+}
 
-                case OP_EQUAL:
-                    // int const == int const => bool const
-                    CONCAT_2INT_RBOOL(*expr_ptr, ==);
+static value_range range_of_call(ast_node *call, range_env *env) {
+    algorithm *callee = get_algorithm(g_ralgs, call->call.function_name);
+    struct alg_ranges *r = get_alg_ranges(get_alg_name(callee));
+    int pcount = params_count(get_alg_variables(callee));
 
-                    break;
-                
-                case OP_SGT:
-                    // int const > int const => bool const
-                    CONCAT_2INT_RBOOL(*expr_ptr, >);
+    for (int i = 0; i < call->call.params_count; ++i) {
+        value_range arg = range_of_expr(&(call->call.parameters_expr[i]), env);
+        if (i < pcount && env->reachable) {
+            range_update(r, &(r->params[i]), &(r->next_params[i]), arg);
+        }
+    }
+    if (env->reachable && !r->called) {
+        r->called = 1;
+        g_rchanged = 1;
+    }
+    return r->ret;
+}
 
-                    break;
+static value_range range_of_expr(node_id *expr_slot, range_env *env) {
+    ast_node *expr = node_at(*expr_slot);
+    value_range r1, r2;
+    int result;
 
-                case OP_EGT:
-                    // int const >= int const => bool const
-                    CONCAT_2INT_RBOOL(*expr_ptr, >=);
+    switch (expr->type) {
+        case NODE_CONST_INT:
+        case NODE_CONST_BOOL:
+            return RANGE_CONST(wrap_word(expr->number_value));
 
-                    break;
+        case NODE_SYMBOL:
+            return env->reachable ? env->vars[range_slot(expr)] : RANGE_EMPTY;
 
-                case OP_SLT:
-                    // int const < int const => bool const
-                    CONCAT_2INT_RBOOL(*expr_ptr, <);
+        case NODE_CALL:
+            return range_of_call(expr, env);
 
-                    break;
+        case NODE_UNARY_OPERATOR:
+            r1 = range_of_expr(&(expr->unary_operator.operand), env);
+            if (IS_EMPTY_RANGE(r1)) return RANGE_EMPTY;
+            return IS_SINGLE_RANGE(r1) ? RANGE_CONST(!r1.lo) : RANGE_BOOL;
 
-                case OP_ELT:
-                    // int const <= int const => bool const
-                    CONCAT_2INT_RBOOL(*expr_ptr, <=);
+        case NODE_BINARY_OPERATOR:
+            r1 = range_of_expr(&(expr->binary_operator.left), env);
+            r2 = range_of_expr(&(expr->binary_operator.right), env);
+            if (IS_EMPTY_RANGE(r1) || IS_EMPTY_RANGE(r2)) return RANGE_EMPTY;
 
-                    break;
+            switch (expr->binary_operator.operator) {
+                case OP_DIV:
+                    if (g_rapply && !HAS_ZERO(r2) && !expr->binary_operator.divisor_nonzero) {
+                        expr->binary_operator.divisor_nonzero = 1;
+                        O_DEBUG("Division by zero check removed, divisor range excludes 0");
+                    }
+                    return range_arith(OP_DIV, r1, r2);
+                case OP_ADD:
+                case OP_SUB:
+                case OP_MUL:
+                    return range_arith(expr->binary_operator.operator, r1, r2);
+                case OP_AND:
+                    if ((IS_SINGLE_RANGE(r1) && r1.lo == 0) || (IS_SINGLE_RANGE(r2) && r2.lo == 0)) return RANGE_CONST(0);
+                    return IS_SINGLE_RANGE(r1) && IS_SINGLE_RANGE(r2) ? RANGE_CONST(1) : RANGE_BOOL;
+                case OP_OR:
+                    if ((IS_SINGLE_RANGE(r1) && r1.lo == 1) || (IS_SINGLE_RANGE(r2) && r2.lo == 1)) return RANGE_CONST(1);
+                    return IS_SINGLE_RANGE(r1) && IS_SINGLE_RANGE(r2) ? RANGE_CONST(0) : RANGE_BOOL;
+                default:
+                    if (!range_compare(expr->binary_operator.operator, r1, r2, &result)) {
+                        return RANGE_BOOL;
+                    }
+                    if (g_rapply && is_pure_expr(expr)) {
+                        *expr_slot = id_of(make_bool(result));
+                        g_rfolded++;
+                        O_DEBUGF("Comparison %s precalculated from value ranges", b_op_to_str(expr->binary_operator.operator));
+                    }
+                    return RANGE_CONST(result);
+            }
+
+        default:
+            ERROR("Node type is not an expression (value ranges)\n");
+    }
+}
+
+static void range_refine_var(range_env *env, int slot, value_range r) {
+    env->vars[slot] = range_meet(env->vars[slot], r);
+    if (IS_EMPTY_RANGE(env->vars[slot])) {
+        env->reachable = 0;
+    }
+}
+
+// Restreint symbol pour que (symbol op bound) soit vrai sur sipro
+static void range_refine_comparison(range_env *env, ast_node *symbol, binary_operator_t operator, value_range bound) {
+    int slot = range_slot(symbol);
+    value_range var = env->vars[slot];
+    if (IS_EMPTY_RANGE(bound) || IS_EMPTY_RANGE(var)) return;
+
+    switch (operator) {
+        case OP_EQUAL:
+            range_refine_var(env, slot, bound);
+            break;
+        case OP_NEQUAL:
+            if (IS_SINGLE_RANGE(bound) && var.lo == bound.lo) range_refine_var(env, slot, range_make((long long) var.lo + 1, var.hi));
+            else if (IS_SINGLE_RANGE(bound) && var.hi == bound.lo) range_refine_var(env, slot, range_make(var.lo, (long long) var.hi - 1));
+            break;
+        // Inférieur en non signé à une borne positive : positif en signé
+        case OP_SLT:
+            if (bound.lo >= 0) range_refine_var(env, slot, (value_range) { 0, bound.hi - 1 });
+            break;
+        case OP_ELT:
+            if (bound.lo >= 0) range_refine_var(env, slot, (value_range) { 0, bound.hi });
+            break;
+        case OP_SGT:
+            if (bound.lo >= 0 && var.lo >= 0) range_refine_var(env, slot, range_make((long long) bound.lo + 1, WORD_MAX));
+            break;
+        case OP_EGT:
+            if (bound.lo >= 0 && var.lo >= 0) range_refine_var(env, slot, (value_range) { bound.lo, WORD_MAX });
+            break;
+        default:
+            break;
+    }
+}
+
+// Restreint l'environnement aux états où cond vaut truth
+static void range_refine(range_env *env, ast_node *cond, int truth) {
+    if (!env->reachable) return;
+
+    binary_operator_t operator;
+    switch (cond->type) {
+        case NODE_CONST_BOOL:
+            if (cond->number_value != truth) env->reachable = 0;
+            break;
+
+        case NODE_UNARY_OPERATOR:
+            if (cond->unary_operator.operator == OP_NOT) {
+                range_refine(env, node_at(cond->unary_operator.operand), !truth);
+            }
+            break;
 
+        case NODE_BINARY_OPERATOR:
+            operator = cond->binary_operator.operator;
+            if ((operator == OP_AND && truth) || (operator == OP_OR && !truth)) {
+                range_refine(env, LEFT(cond), truth);
+                range_refine(env, RIGHT(cond), truth);
+                break;
+            }
+            if (!truth && !negated_comparison(operator, &operator)) break;
 
-                default: break;
+            int apply = g_rapply;
+            g_rapply = 0;
+            if (IS_SYMBOL(LEFT(cond))) {
+                range_refine_comparison(env, LEFT(cond), operator, range_of_expr(&(cond->binary_operator.right), env));
+            }
+            if (IS_SYMBOL(RIGHT(cond)) && env->reachable) {
+                range_refine_comparison(env, RIGHT(cond), swapped_comparison(operator), range_of_expr(&(cond->binary_operator.left), env));
             }
+            g_rapply = apply;
             break;
 
         default:
@@ -1047,291 +4113,338 @@ static void optimize_expr(ast_node **expr_ptr) {
     }
 }
 
-static void optimize_const_expr(ast_node *ast) {
-    if (ast == NULL) return;
+static void range_of_statement(ast_node *ast, range_env *env);
+
+// Point fixe d'une boucle : head est l'état en tête de boucle, modifié
+static void range_of_loop(ast_node *loop, range_env *head) {
+    int apply = g_rapply;
+    g_rapply = 0;
+
+    for (int iteration = 0; ; ++iteration) {
+        range_env *body = range_env_copy(head);
+        if (loop->type == NODE_DO_WHILE) {
+            range_of_expr(&(loop->do_while.condition), body);
+            range_refine(body, node_at(loop->do_while.condition), 1);
+            range_of_statement(loop->do_while.body, body);
+        } else {
+            range_refine_comparison(body, loop, OP_ELT, range_of_expr(&(loop->do_for_i->end_expr), body));
+            range_of_statement(loop->do_for_i->body, body);
+            if (body->reachable) {
+                int slot = range_slot(loop);
+                body->vars[slot] = range_arith(OP_ADD, body->vars[slot], RANGE_CONST(1));
+            }
+        }
 
-    switch (ast->type) {
-        case NODE_FUNCTION:
-            optimize_const_expr(ast->function.body); break;
-        case NODE_SEQUENCE:
-            optimize_const_expr(ast->sequence.first);
-            optimize_const_expr(ast->sequence.second); break;
-        case NODE_ASSIGNEMENT:
-            optimize_expr(&(ast->assignement.expr)); break;
-        case NODE_RETURN:
-            optimize_expr(&(ast->inst_return.expr)); break;
-        case NODE_IF_STATEMENT:
-            optimize_expr(&(ast->if_statement.condition));
-            optimize_const_expr(ast->if_statement.then_block);
-            optimize_const_expr(ast->if_statement.else_block); break;
-        case NODE_DO_FOR_I:
-            optimize_expr(&(ast->do_for_i.start_expr));
-            optimize_expr(&(ast->do_for_i.end_expr));
-            optimize_const_expr(ast->do_for_i.body); break;
-        case NODE_DO_WHILE:
-            optimize_expr(&(ast->do_while.condition));
-            optimize_const_expr(ast->do_while.body); break;
-        default:
-            break;
+        range_env *next = range_env_copy(head);
+        range_env_join(next, body);
+        range_env_dispose(body);
+        int stable = range_env_equal(next, head);
+        if (iteration >= RANGE_WIDEN_AFTER) {
+            range_env_widen(head, next);
+        } else {
+            range_env_assign(head, next);
+        }
+        range_env_dispose(next);
+        if (stable) break;
+    }
+
+    // Passe finale sur l'état stable : seule celle-ci peut modifier l'AST
+    g_rapply = apply;
+    if (apply) {
+        range_env *body = range_env_copy(head);
+        if (loop->type == NODE_DO_WHILE) {
+            range_of_expr(&(loop->do_while.condition), body);
+            range_refine(body, node_at(loop->do_while.condition), 1);
+            range_of_statement(loop->do_while.body, body);
+        } else {
+            value_range end = range_of_expr(&(loop->do_for_i->end_expr), body);
+            // -1 vaut 0xFFFF, que le compteur ne dépasse jamais : les littéraux
+            //   étant ramenés à leur mot, 65535 a ici l'intervalle {-1, -1}
+            loop->do_for_i->end_bounded = !IS_EMPTY_RANGE(end) && (end.lo > -1 || end.hi < -1);
+            range_refine_comparison(body, loop, OP_ELT, end);
+            range_of_statement(loop->do_for_i->body, body);
+        }
+        range_env_dispose(body);
     }
 }
 
-static void optimize_dead_blocks(ast_node **ast_ptr) {
-    ast_node *ast = *ast_ptr;
-    if (ast == NULL) return;
+static void range_of_statement(ast_node *ast, range_env *env) {
+    if (ast == NULL || !env->reachable) return;
 
+    range_env *other;
+    value_range values[MAX_PARAMS_COUNT];
+    struct alg_ranges *r;
     switch (ast->type) {
         case NODE_FUNCTION:
-            optimize_dead_blocks(&(ast->function.body)); break;
-        case NODE_SEQUENCE: // if return delete after
-            optimize_dead_blocks(&(ast->sequence.first));
-            optimize_dead_blocks(&(ast->sequence.second));
-            if (check_all_path_returns(ast->sequence.first)) {
-                // La seconde partie de la sequence ne sera jamais executee
-                OC(); O_DEBUG("Removing useless code after return statement");
-                *ast_ptr = ast->sequence.first;
-                break;
-            }
-            if (ast->sequence.first == NULL && ast->sequence.second == NULL) {
-                OC(); O_DEBUG("Removed empty sequence");
-                *ast_ptr = NULL;
-                break;
-            }
-            ast_node *rplc_inst = NULL;
-            if (ast->sequence.first == NULL) rplc_inst = ast->sequence.second;
-            if (ast->sequence.second == NULL) rplc_inst = ast->sequence.first;
-            if (rplc_inst != NULL) {
-                *ast_ptr = rplc_inst;
-                OC(); O_DEBUG("Removed half empty sequence");
+            range_of_statement(ast->function.body, env);
+            break;
+
+        case NODE_SEQUENCE:
+            for (int i = 0; i < ast->sequence.count; ++i) {
+                range_of_statement(ast->sequence.statements[i], env);
             }
             break;
-        
+
+        case NODE_ASSIGNEMENT:
+            values[0] = range_of_expr(&(ast->assignement.expr), env);
+            env->vars[range_slot(ast)] = values[0];
+            break;
+
+        case NODE_RETURN:
+            values[0] = range_of_expr(&(ast->inst_return.expr), env);
+            r = get_alg_ranges(get_alg_name(g_rcurrent));
+            range_update(r, &(r->ret), &(r->next_ret), values[0]);
+            env->reachable = 0;
+            break;
+
         case NODE_IF_STATEMENT:
-            optimize_dead_blocks(&(ast->if_statement.then_block));
-            optimize_dead_blocks(&(ast->if_statement.else_block));
-            // Supprime les ifs dont les conditions sont constantes
-            if (IS_BOOL_CONST(ast->if_statement.condition)) {
-                OC(); O_DEBUG("If statement reduction, condition was bool constant");
-                if (ast->if_statement.condition->number_value != 0) { // if (true)
-                    *ast_ptr = ast->if_statement.then_block;
-                } else { // if (false)
-                    *ast_ptr = ast->if_statement.else_block;
-                }
-            }
+            range_of_expr(&(ast->if_statement.condition), env);
+            other = range_env_copy(env);
+            range_refine(env, node_at(ast->if_statement.condition), 1);
+            range_refine(other, node_at(ast->if_statement.condition), 0);
+            range_of_statement(ast->if_statement.then_block, env);
+            range_of_statement(ast->if_statement.else_block, other);
+            range_env_join(env, other);
+            range_env_dispose(other);
+            break;
 
-            // Déplace le block ELSE dans THEN si le block THEN est vide
-            if (ast->if_statement.then_block == NULL && ast->if_statement.else_block != NULL) {
-                OC(); O_DEBUG("If statement switch, THEN block was empty while ELSE wasn't");
-                ast->if_statement.condition = make_unary_operator(OP_NOT, ast->if_statement.condition);
-                ast->if_statement.then_block = ast->if_statement.else_block;
-                ast->if_statement.else_block = NULL;
-            }
+        case NODE_DO_WHILE:
+            range_of_loop(ast, env);
+            range_refine(env, node_at(ast->do_while.condition), 0);
             break;
 
         case NODE_DO_FOR_I:
-            optimize_dead_blocks(&(ast->do_for_i.body));
-            if (IS_INT_CONST(ast->do_for_i.start_expr) && IS_INT_CONST(ast->do_for_i.end_expr)) {
-                if (ast->do_for_i.start_expr->number_value > ast->do_for_i.end_expr->number_value) {
-                    // La boucle ne fera aucun tour
-                    OC(); O_DEBUG("Do for statement reduction, no iterations");
-                    *ast_ptr = NULL;
-                }
-            }
+            values[0] = range_of_expr(&(ast->do_for_i->start_expr), env);
+            env->vars[range_slot(ast)] = values[0];
+            range_of_loop(ast, env);
             break;
 
-        case NODE_DO_WHILE:
-            optimize_dead_blocks(&(ast->do_while.body));
-            if (IS_BOOL_CONST(ast->do_while.condition) && ast->do_while.condition->number_value == 0) {
-                // La boucle ne fera aucun tour
-                OC(); O_DEBUG("While statement reduction, no iterations");
-                *ast_ptr = NULL;
+        case NODE_SPEC_PARAMS_REASSIGN:
+            for (int i = 0; i < ast->spec_params_reassign.params_count; ++i) {
+                values[i] = range_of_expr(&(ast->spec_params_reassign.parameters_expr[i]), env);
+            }
+            for (int i = 0; i < ast->spec_params_reassign.params_count; ++i) {
+                env->vars[i] = values[i];
             }
             break;
 
-        default: break;
+        default:
+            ERROR("Unknown statement during value ranges analysis\n");
     }
 }
 
-struct derecursification_information {
-    enum { DR_END, DR_IF_ELSE } dr_type;
-    ast_node *func;
-    union {
-        struct { ast_node **return_s_ptr; } dr_end;
-        struct {
-            ast_node *condition;
-            ast_node *terminate;
-            ast_node **rec_call_body;
-            ast_node **if_ptr;
-            ast_node **return_s_ptr;
-        } dr_if_else;
-    };
-};
+static void range_of_alg([[ maybe_unused ]] const char *alg_name, algorithm *alg) {
+    struct alg_ranges *r = get_alg_ranges(get_alg_name(alg));
+    if (!r->called) return;
 
-static void optimize_tail_call_rebuild_func(const struct derecursification_information *infos) {
-    ast_node *calln;
-    switch (infos->dr_type) {
-        case DR_END:
-            calln = (*infos->dr_end.return_s_ptr)->inst_return.expr;
-            *infos->dr_end.return_s_ptr = NULL;
-            infos->func->function.body = make_do_while(
-                make_bool(1),
-                make_sequence(
-                    infos->func->function.body,
-                    make_spec_params_reassign(calln->call.parameters_expr, calln->call.params_count)
-                )
-            );
-            break;
-        
-        case DR_IF_ELSE:
-            calln = (*infos->dr_if_else.return_s_ptr)->inst_return.expr;
-            *infos->dr_if_else.return_s_ptr = NULL;
-            *infos->dr_if_else.if_ptr = NULL;
-            ast_node *start_body = infos->func->function.body;
-            infos->func->function.body = make_sequence(
-                start_body,
-                make_sequence(   
-                    make_do_while(
-                        make_unary_operator(OP_NOT, infos->dr_if_else.condition),
-                        make_sequence(
-                            make_sequence(
-                                *infos->dr_if_else.rec_call_body,
-                                make_spec_params_reassign(calln->call.parameters_expr, calln->call.params_count)
-                            ),
-                            start_body
-                        )
-                    ),
-                    infos->dr_if_else.terminate
-                )
-            );
-            break;
+    variables_map *vars = get_alg_variables(alg);
+    range_env *env = range_env_create(params_count(vars) + locals_count(vars));
+    for (int i = 0; i < params_count(vars); ++i) {
+        env->vars[i] = r->params[i];
+    }
 
-        default:
-            ERROR("Derecursification informations are invalid\n");
+    g_rcurrent = alg;
+    range_of_statement(get_alg_tree(alg), env);
+    g_rcurrent = NULL;
+    range_env_dispose(env);
+}
+
+static void range_narrow_alg([[ maybe_unused ]] const char *alg_name, algorithm *alg) {
+    struct alg_ranges *r = get_alg_ranges(get_alg_name(alg));
+    for (int i = 0; i < params_count(get_alg_variables(alg)); ++i) {
+        if (!SAME_RANGE(r->params[i], r->next_params[i])) g_rchanged = 1;
+        r->params[i] = r->next_params[i];
+        r->next_params[i] = RANGE_EMPTY;
     }
+    if (!SAME_RANGE(r->ret, r->next_ret)) g_rchanged = 1;
+    r->ret = r->next_ret;
+    r->next_ret = RANGE_EMPTY;
 }
 
-static int is_recursive_return(const char *alg_name, ast_node *return_s) {
-    if (return_s->type != NODE_RETURN) return 0;
-    if (return_s->inst_return.expr->type == NODE_CALL
-        && strcmp(alg_name, return_s->inst_return.expr->call.function_name) == 0) {
-            return 1;
+static void range_print_alg([[ maybe_unused ]] const char *alg_name, algorithm *alg) {
+    struct alg_ranges *r = get_alg_ranges(get_alg_name(alg));
+    const char **pnames = get_all_param_names(get_alg_variables(alg));
+    printf("Value ranges of %s:", get_alg_name(alg));
+    for (int i = 0; pnames[i] != NULL; ++i) {
+        printf(" %s in [%d, %d]", pnames[i], r->params[i].lo, r->params[i].hi);
     }
-    return 0;
+    printf(" returns [%d, %d]\n", r->ret.lo, r->ret.hi);
 }
 
-static ast_node **get_last_instruction(ast_node **ast_ptr) {
-    ast_node *ast = *ast_ptr;
-    
-    if (ast == NULL) return NULL;
+static void range_seed_main_call(ast_node *main_call) {
+    range_env *env = range_env_create(0);
+    node_id main_slot = id_of(main_call);
+    range_of_expr(&main_slot, env);
+    range_env_dispose(env);
+}
 
-    switch (ast->type) {
-        case NODE_SEQUENCE:
-            ast_node **snd = get_last_instruction(&(ast->sequence.second));
-            if (snd != NULL) return snd;
-            return get_last_instruction(&(ast->sequence.first));
+int analyze_value_ranges(algorithms_map *algs, ast_node *main_call, int debug) {
+    g_passes.ranges = hashtable_empty_cr();
+    g_ralgs = algs;
+    g_odebug = debug;
+    g_rapply = 0;
+    g_rfolded = 0;
 
-        default:
-            return ast_ptr;
+    // Point fixe (avec élargissement) sur les paramètres et les retours
+    g_rnarrowing = 0;
+    do {
+        g_rchanged = 0;
+        range_seed_main_call(main_call);
+        foreach_algorithm(algs, range_of_alg);
+    } while (g_rchanged);
+
+    // Rétrécissement : l'image d'un post point fixe en est encore un
+    for (int i = 0; i < RANGE_NARROW_ROUNDS; ++i) {
+        g_rnarrowing = 1;
+        range_seed_main_call(main_call);
+        foreach_algorithm(algs, range_of_alg);
+        g_rnarrowing = 0;
+        g_rchanged = 0;
+        foreach_algorithm(algs, range_narrow_alg);
+        if (!g_rchanged) break;
     }
+
+    // Application aux divisions et aux comparaisons
+    if (debug) foreach_algorithm(algs, range_print_alg);
+    g_rapply = 1;
+    g_rnarrowing = 1;
+    foreach_algorithm(algs, range_of_alg);
+    g_rapply = 0;
+    g_rnarrowing = 0;
+
+    return g_rfolded;
 }
 
-// Au premier appel, (*ast_ptr)->type == NODE_FUNCTION
-static struct derecursification_information *optimize_make_drec_infos(const char *alg_name, ast_node **ast_ptr) {
-    ast_node *ast = *ast_ptr;
-    struct derecursification_information *ret;
+static void dispose_alg_ranges([[ maybe_unused ]] const void *alg_name, const void *ranges) {
+    struct alg_ranges *r = (struct alg_ranges *) ranges;
+    free(r->params);
+    free(r->next_params);
+    free(r);
+}
 
-    if (ast == NULL) {
-        return NULL;
-    }
+void dispose_value_ranges(void) {
+    if (g_passes.ranges == NULL) return;
+    hashtable_foreach(g_passes.ranges, dispose_alg_ranges);
+    hashtable_dispose(&g_passes.ranges);
+}
+
+
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  ---------------------------   Mémoïsation   ----------------------------  //
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  ------------------------------------------------------------------------  //
+//  Un algorithme pur qui s'appelle plusieurs fois lui-même, et dont les
+//    paramètres ne prennent que peu de valeurs (intervalles de valeurs),
+//    garde ses résultats dans une table @int placée avant la pile.
+#define MEMO_MAX_ENTRIES 1024
 
+static _Thread_local int g_mcount;
+
+static int self_calls_count(const ast_node *ast, const char *alg_name) {
+    if (ast == NULL) return 0;
+    int count = 0;
     switch (ast->type) {
-        case NODE_FUNCTION:
-            struct derecursification_information *result = optimize_make_drec_infos(alg_name, &(ast->function.body));
-            if (result == NULL) {
-                return NULL;
+        case NODE_UNARY_OPERATOR:
+            return self_calls_count(node_at(ast->unary_operator.operand), alg_name);
+        case NODE_BINARY_OPERATOR:
+            return self_calls_count(node_at(ast->binary_operator.left), alg_name) + self_calls_count(node_at(ast->binary_operator.right), alg_name);
+        case NODE_CALL:
+            count = ast->call.function_name == alg_name;
+            for (int i = 0; i < ast->call.params_count; ++i) {
+                count += self_calls_count(node_at(ast->call.parameters_expr[i]), alg_name);
             }
-            result->func = ast;
-            return result;
-        
-        case NODE_SEQUENCE:
-            return (ast->sequence.second == NULL) ?
-                optimize_make_drec_infos(alg_name, &(ast->sequence.first)) :
-                optimize_make_drec_infos(alg_name, &(ast->sequence.second));
-        
+            return count;
+        case NODE_ASSIGNEMENT:
+            return self_calls_count(node_at(ast->assignement.expr), alg_name);
         case NODE_RETURN:
-            if (!is_recursive_return(alg_name, ast)) return NULL;
-            ret = cralloc(sizeof *ret);
-            ret->dr_type = DR_END;
-            ret->dr_end.return_s_ptr = ast_ptr;
-            return ret;
-
+            return self_calls_count(node_at(ast->inst_return.expr), alg_name);
         case NODE_IF_STATEMENT:
-            ret = cralloc(sizeof *ret);
-            ast_node **last_inst = get_last_instruction(&(ast->if_statement.else_block));
-            if (is_recursive_return(alg_name, *last_inst)) {
-                ret->dr_type = DR_IF_ELSE;
-                ret->dr_if_else.condition = ast->if_statement.condition;
-                ret->dr_if_else.rec_call_body = &(ast->if_statement.else_block);
-                ret->dr_if_else.terminate = ast->if_statement.then_block;
-                ret->dr_if_else.if_ptr = ast_ptr;
-                ret->dr_if_else.return_s_ptr = last_inst;
-                return ret;
+            return self_calls_count(node_at(ast->if_statement.condition), alg_name)
+                + self_calls_count(ast->if_statement.then_block, alg_name)
+                + self_calls_count(ast->if_statement.else_block, alg_name);
+        case NODE_DO_FOR_I:
+            return self_calls_count(node_at(ast->do_for_i->start_expr), alg_name)
+                + self_calls_count(node_at(ast->do_for_i->end_expr), alg_name)
+                + self_calls_count(ast->do_for_i->body, alg_name);
+        case NODE_DO_WHILE:
+            return self_calls_count(node_at(ast->do_while.condition), alg_name) + self_calls_count(ast->do_while.body, alg_name);
+        case NODE_FUNCTION:
+            return self_calls_count(ast->function.body, alg_name);
+        case NODE_SEQUENCE:
+            for (int i = 0; i < ast->sequence.count; ++i) {
+                count += self_calls_count(ast->sequence.statements[i], alg_name);
             }
-            last_inst = get_last_instruction(&(ast->if_statement.then_block));
-            if (is_recursive_return(alg_name, *last_inst)) {
-                ret->dr_type = DR_IF_ELSE;
-                ret->dr_if_else.condition = make_unary_operator(OP_NOT, ast->if_statement.condition);
-                ret->dr_if_else.rec_call_body = &(ast->if_statement.then_block);
-                ret->dr_if_else.terminate = ast->if_statement.else_block;
-                ret->dr_if_else.if_ptr = ast_ptr;
-                ret->dr_if_else.return_s_ptr = last_inst;
-                return ret;
+            return count;
+        case NODE_SPEC_PARAMS_REASSIGN:
+            for (int i = 0; i < ast->spec_params_reassign.params_count; ++i) {
+                count += self_calls_count(node_at(ast->spec_params_reassign.parameters_expr[i]), alg_name);
             }
-            free(ret);
-            return NULL;
+            return count;
         default:
-            return NULL;
+            return 0;
     }
 }
 
-static void optimize_tail_call_recursion(algorithm *alg, ast_node *ast) {
-    if (ast == NULL || ast->type != NODE_FUNCTION) return;
-
-    struct derecursification_information *infos =
-        optimize_make_drec_infos(get_alg_name(alg), &ast);
-
-    if (infos == NULL) {
+static void memoize_alg([[ maybe_unused ]] const char *alg_name, algorithm *alg) {
+    ast_node *tree = get_alg_tree(alg);
+    struct alg_ranges *r = hashtable_search(g_passes.ranges, get_alg_name(alg));
+    if (tree->function.memo != NULL || !is_alg_pure(alg) || r == NULL || !r->called
+            || self_calls_count(tree, get_alg_name(alg)) < 2) {
         return;
     }
 
-    optimize_tail_call_rebuild_func(infos);
-    free(infos);
+    variables_map *vars = get_alg_variables(alg);
+    memo_table memo = { .size = 1 };
+    for (int i = params_count(vars) - 1; i >= 0; --i) {
+        long long span = (long long) r->params[i].hi - r->params[i].lo + 1;
+        if (IS_EMPTY_RANGE(r->params[i]) || span * memo.size > MEMO_MAX_ENTRIES) {
+            O_DEBUGF("%s not memoized, too many possible parameter values", get_alg_name(alg));
+            return;
+        }
+        memo.lo[i] = r->params[i].lo;
+        memo.stride[i] = memo.size;
+        memo.size *= (int) span;
+    }
 
-    OC();
-    O_DEBUGF("Tail call recursion removed for function %s", get_alg_name(alg));
+    tree->function.memo = arena_alloc(get_alg_arena(alg), sizeof memo);
+    *tree->function.memo = memo;
+    tree->function.memo->index = create_local(vars, intern(MEMO_INDEX_VAR));
+    g_mcount++;
+    O_DEBUGF("%s memoized in a table of %d entries", get_alg_name(alg), memo.size);
 }
 
-void optimize_ast(algorithms_map *algs, ast_node *ast, int debug) {
-    if (ast->type != NODE_FUNCTION) {
-        ERROR("Cannot optimize a non function AST\n");
-    }
-
+int memoize_algorithms(algorithms_map *algs, int debug) {
+    if (g_passes.ranges == NULL) return 0;
     g_odebug = debug;
-    if (debug) printf("Optimize start for function %s\n", ast->function.function_name);
-    
-    do {
-        g_ochanged = 0;
-
-        optimize_const_expr(ast);
-        
-        optimize_dead_blocks(&ast);
-
-        algorithm *alg = get_algorithm(algs, ast->function.function_name);
-        optimize_tail_call_recursion(alg, ast);
-
-    } while (g_ochanged > 0);
+    g_mcount = 0;
+    foreach_algorithm(algs, memoize_alg);
+    return g_mcount;
+}
 
-    if (debug) printf("Optimize end\n\n");
+// État des passes laissé par une compilation, interrompue ou non : une
+//   compilation suivante dans le même thread ne doit pas le voir
+void reset_ast_passes(void) {
+    g_ast_arena = NULL;
+    g_resolving = 0;
+    free(g_type_queue);
+    g_type_queue = NULL;
+    hashtable_dispose(&g_type_queued);
+    g_writing = 0;
+    free(sbf);
+    sbf = NULL;
+    g_instructions_output = NULL;
+    g_label_namespace = MAIN_LABEL_NAMESPACE;
+    free_jump_tables(g_jump_tables, g_jump_tables_count);
+    g_jump_tables = NULL;
+    g_jump_tables_count = 0;
+    dispose_value_ranges();
+    // Les nœuds sont libérés avec les arènes des algorithmes
+    dispose_ast_nodes(&g_passes.nodes);
+    use_ast_nodes(NULL);
+    g_passes = (ast_passes_state) { NULL, NULL, NULL };
 }
 
 
@@ -1345,7 +4458,7 @@ void optimize_ast(algorithms_map *algs, ast_node *ast, int debug) {
 ast_node *make_int(int value) {
     ast_node *node = cranode();
     node->type = NODE_CONST_INT;
-    node->number_value = value;
+    node->number_value = wrap_word(value); // Forme du mot sur la cible
     return node;
 }
 
@@ -1359,14 +4472,15 @@ ast_node *make_bool(int bool_value) {
 ast_node *make_symbol(const char *symbol) {
     ast_node *node = cranode();
     node->type = NODE_SYMBOL;
-    node->symbol_name = mstrcpy(symbol);
+    node->symbol_name = symbol;
+    node->symbol_var = NULL;
     return node;
 }
 
 ast_node *make_unary_operator(unary_operator_t operator, ast_node *operand) {
     ast_node *node = cranode();
     node->type = NODE_UNARY_OPERATOR;
-    node->unary_operator.operand = operand;
+    node->unary_operator.operand = id_of(operand);
     node->unary_operator.operator = operator;
     node->unary_operator.result_type = TYPE_UNKNOWN;
     return node;
@@ -1375,33 +4489,38 @@ ast_node *make_unary_operator(unary_operator_t operator, ast_node *operand) {
 ast_node *make_binary_operator(ast_node *left, binary_operator_t operator, ast_node *right) {
     ast_node *node = cranode();
     node->type = NODE_BINARY_OPERATOR;
-    node->binary_operator.left = left;
+    node->binary_operator.left = id_of(left);
     node->binary_operator.operator = operator;
-    node->binary_operator.right = right;
+    node->binary_operator.right = id_of(right);
     node->binary_operator.result_type = TYPE_UNKNOWN;
+    node->binary_operator.divisor_nonzero = 0;
     return node;
 }
 
 ast_node *make_assignement(const char *var_name, ast_node *expr) {
     ast_node *node = cranode();
     node->type = NODE_ASSIGNEMENT;
-    node->assignement.var_name = mstrcpy(var_name);
-    node->assignement.expr = expr;
+    node->assignement.var_name = var_name;
+    node->assignement.var = NULL;
+    node->assignement.expr = id_of(expr);
     return node;
 }
 
 ast_node *make_return(ast_node *expr) {
     ast_node *node = cranode();
     node->type = NODE_RETURN;
-    node->inst_return.expr = expr;
+    node->inst_return.expr = id_of(expr);
     return node;
 }
 
 ast_node *make_call(const char *function_name, ast_node **parameters, int params_count) {
     ast_node *node = cranode();
     node->type = NODE_CALL;
-    node->call.function_name = mstrcpy(function_name);
-    node->call.parameters_expr = parameters;
+    node->call.function_name = function_name;
+    node->call.parameters_expr = arena_alloc(g_ast_arena, (size_t) (params_count > 0 ? params_count : 1) * sizeof *node->call.parameters_expr);
+    for (int i = 0; i < params_count; ++i) {
+        node->call.parameters_expr[i] = id_of(parameters[i]);
+    }
     node->call.params_count = params_count;
     return node;
 }
@@ -1409,7 +4528,7 @@ ast_node *make_call(const char *function_name, ast_node **parameters, int params
 ast_node *make_if_statement(ast_node *condition, ast_node *then_block, ast_node *else_block) {
     ast_node *node = cranode();
     node->type = NODE_IF_STATEMENT;
-    node->if_statement.condition = condition;
+    node->if_statement.condition = id_of(condition);
     node->if_statement.then_block = then_block;
     node->if_statement.else_block = else_block;
     return node;
@@ -1418,17 +4537,20 @@ ast_node *make_if_statement(ast_node *condition, ast_node *then_block, ast_node
 ast_node *make_do_for_i(const char *var_name, ast_node *start_expr, ast_node *end_expr, ast_node *body) {
     ast_node *node = cranode();
     node->type = NODE_DO_FOR_I;
-    node->do_for_i.var_name = mstrcpy(var_name);
-    node->do_for_i.start_expr = start_expr;
-    node->do_for_i.end_expr = end_expr;
-    node->do_for_i.body = body;
+    node->do_for_i = arena_alloc(g_ast_arena, sizeof *node->do_for_i);
+    node->do_for_i->var_name = var_name;
+    node->do_for_i->var = NULL;
+    node->do_for_i->start_expr = id_of(start_expr);
+    node->do_for_i->end_expr = id_of(end_expr);
+    node->do_for_i->body = body;
+    node->do_for_i->end_bounded = 0;
     return node;
 }
 
 ast_node *make_do_while(ast_node *condition, ast_node *body) {
     ast_node *node = cranode();
     node->type = NODE_DO_WHILE;
-    node->do_while.condition = condition;
+    node->do_while.condition = id_of(condition);
     node->do_while.body = body;
     return node;
 }
@@ -1436,20 +4558,34 @@ ast_node *make_do_while(ast_node *condition, ast_node *body) {
 ast_node *make_function(const char *function_name, ast_node *body) {
     ast_node *node = cranode();
     node->type = NODE_FUNCTION;
-    node->function.function_name = mstrcpy(function_name);
+    node->function.function_name = function_name;
     node->function.body = body;
+    node->function.memo = NULL;
     return node;
 }
 
 ast_node *make_sequence(ast_node *first, ast_node *second) {
     ast_node *node = cranode();
     node->type = NODE_SEQUENCE;
-    node->sequence.first = first;
-    node->sequence.second = second;
+    node->sequence.statements = NULL;
+    node->sequence.count = 0;
+    node->sequence.capacity = 0;
+    sequence_append(node, first);
+    sequence_append(node, second);
     return node;
 }
 
-ast_node *make_spec_params_reassign(ast_node **params_expr, int pcount) {
+ast_node *append_statement(ast_node *block, ast_node *statement) {
+    if (block == NULL || block->type != NODE_SEQUENCE) {
+        ast_node *node = make_sequence(block, statement);
+        node->line = block != NULL ? block->line : -1;
+        return node;
+    }
+    sequence_append(block, statement);
+    return block;
+}
+
+ast_node *make_spec_params_reassign(node_id *params_expr, int pcount) {
     ast_node *node = cranode();
     node->type = NODE_SPEC_PARAMS_REASSIGN;
     node->spec_params_reassign.parameters_expr = params_expr;
@@ -1501,42 +4637,42 @@ static void print_ast_aux(const ast_node *ast, int depth) {
             break;
         case NODE_UNARY_OPERATOR:
             printf("%sUnary expression, OP: %d, result in %s\n", prefix, ast->unary_operator.operator, value_type_to_string(ast->unary_operator.result_type));
-            print_ast_aux(ast->unary_operator.operand, D);
+            print_ast_aux(node_at(ast->unary_operator.operand), D);
             break;
         case NODE_BINARY_OPERATOR:
             printf("%sExpression, OP: %s, result in %s\n", prefix, b_op_to_str(ast->binary_operator.operator), value_type_to_string(ast->binary_operator.result_type));
-            print_ast_aux(ast->binary_operator.left, D);
-            print_ast_aux(ast->binary_operator.right, D);
+            print_ast_aux(node_at(ast->binary_operator.left), D);
+            print_ast_aux(node_at(ast->binary_operator.right), D);
             break;
         case NODE_ASSIGNEMENT:
             printf("%sAssignement to '%s'\n", prefix, ast->assignement.var_name);
-            print_ast_aux(ast->assignement.expr, D);
+            print_ast_aux(node_at(ast->assignement.expr), D);
             break;
         case NODE_CALL:
             printf("%sCall to %s with %d arg(s)\n", prefix, ast->call.function_name, ast->call.params_count);
             for (int i = 0; i < ast->call.params_count; ++i) {
-                print_ast_aux(ast->call.parameters_expr[i], D);
+                print_ast_aux(node_at(ast->call.parameters_expr[i]), D);
             }
             break;
         case NODE_RETURN:
             printf("%sReturn value\n", prefix);
-            print_ast_aux(ast->inst_return.expr, D);
+            print_ast_aux(node_at(ast->inst_return.expr), D);
             break;
         case NODE_IF_STATEMENT:
             printf("%sIf statement\n", prefix);
-            print_ast_aux(ast->if_statement.condition, D);
+            print_ast_aux(node_at(ast->if_statement.condition), D);
             print_ast_aux(ast->if_statement.then_block, D);
             print_ast_aux(ast->if_statement.else_block, D);
             break;
         case NODE_DO_FOR_I:
-            printf("%sDo for %s increments\n", prefix, ast->do_for_i.var_name);
-            print_ast_aux(ast->do_for_i.start_expr, D);
-            print_ast_aux(ast->do_for_i.end_expr, D);
-            print_ast_aux(ast->do_for_i.body, D);
+            printf("%sDo for %s increments\n", prefix, ast->do_for_i->var_name);
+            print_ast_aux(node_at(ast->do_for_i->start_expr), D);
+            print_ast_aux(node_at(ast->do_for_i->end_expr), D);
+            print_ast_aux(ast->do_for_i->body, D);
             break;
         case NODE_DO_WHILE:
             printf("%sDo while\n", prefix);
-            print_ast_aux(ast->do_while.condition, D);
+            print_ast_aux(node_at(ast->do_while.condition), D);
             print_ast_aux(ast->do_while.body, D);
             break;
         case NODE_FUNCTION:
@@ -1545,13 +4681,14 @@ static void print_ast_aux(const ast_node *ast, int depth) {
             break;
         case NODE_SEQUENCE:
             printf("%sSequence\n", prefix);
-            print_ast_aux(ast->sequence.first, D);
-            print_ast_aux(ast->sequence.second, D);
+            for (int i = 0; i < ast->sequence.count; ++i) {
+                print_ast_aux(ast->sequence.statements[i], D);
+            }
             break;
         case NODE_SPEC_PARAMS_REASSIGN:
             printf("%sParameters reassignement\n", prefix);
             for (int i = 0; i < ast->spec_params_reassign.params_count; ++i) {
-                print_ast_aux(ast->spec_params_reassign.parameters_expr[i], D);
+                print_ast_aux(node_at(ast->spec_params_reassign.parameters_expr[i]), D);
             }
             break;
         default:
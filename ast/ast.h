@@ -18,6 +18,7 @@ typedef enum {
     OP_OR,
 
     OP_EQUAL,
+    OP_NEQUAL,          // Produit par l'optimiseur uniquement (pas de syntaxe)
     OP_SGT,             // Strictly Greater Than
     OP_EGT,             // Equal or Greater Than
     OP_SLT,             // Strictly Less Than
@@ -27,10 +28,16 @@ typedef enum {
 typedef struct ast_node ast_node;
 
 #include "utils.h"
+#include "arena.h"
+#include "intern.h"
 #include "algorithms.h"
 
 extern void resolve_types(algorithms_map *algs);
 
+extern arena *set_ast_arena(arena *nodes); // Arène des make_*, renvoie la précédente
+
+// Les noms passés aux make_* sont internés (intern), par l'analyseur lexical
+//   ou pris à des nœuds existants
 extern ast_node *make_int(int value);
 extern ast_node *make_bool(int bool_value);
 extern ast_node *make_symbol(const char *symbol);
@@ -46,14 +53,38 @@ extern ast_node *make_do_for_i(const char *var_name, ast_node *start_expr, ast_n
 extern ast_node *make_do_while(ast_node *condition, ast_node *body);
 
 extern ast_node *make_function(const char *function_name, ast_node *body);
-extern ast_node *make_sequence(ast_node *first, ast_node *second);
+extern ast_node *make_sequence(ast_node *first, ast_node *second); // À plat, NULL ignorés
+extern ast_node *append_statement(ast_node *block, ast_node *statement); // Modifie block s'il est une séquence
 
 extern int get_line(const ast_node *node);
 extern void set_line(ast_node *node, int line);
 
+extern void compact_ast_trees(algorithms_map *algs); // Range chaque arbre en préordre
 extern void optimize_ast(algorithms_map *algs, ast_node *ast, int debug);
 extern void check_ast_code(ast_node *ast, algorithms_map *algs);
-extern void write_all_instructions(algorithms_map *algs, ast_node *main_call);
+extern int mark_reachable_algorithms(algorithms_map *algs, ast_node *main_call); // Nombre d'algorithmes accessibles
+extern int recognize_idioms(algorithms_map *algs, int debug, int remarks); // Avant resolve_types
+extern int analyze_effects(algorithms_map *algs, int debug); // Nombre de propriétés nouvellement prouvées
+extern int eliminate_dead_arguments(algorithms_map *algs, ast_node *main_call, int debug); // Nombre de paramètres retirés
+extern int analyze_value_ranges(algorithms_map *algs, ast_node *main_call, int debug); // Nombre de comparaisons précalculées
+extern int memoize_algorithms(algorithms_map *algs, int debug); // Après analyze_value_ranges
+extern void dispose_value_ranges(void); // Après memoize_algorithms
+extern void write_all_instructions(algorithms_map *algs, ast_node *main_call, FILE *output, int jobs); // jobs : voir parallel_for
+extern void reset_ast_passes(void); // Après chaque compilation, même interrompue par une erreur
+
+// État qu'une passe laisse aux suivantes, le reste étant fixé à l'entrée de
+//   chaque passe. Une tâche de parallel_for qui touche aux arbres le reprend
+//   du thread appelant, sans quoi elle verrait un état vide
+typedef struct ast_nodes ast_nodes;
+
+typedef struct {
+    ast_nodes *nodes;               // Annuaire des nœuds de la compilation (voir node_at)
+    algorithms_map *effects_algs;   // Résumés d'effets à jour, NULL avant analyze_effects
+    hashtable *ranges;              // Nom d'algorithme -> struct alg_ranges, NULL hors analyse
+} ast_passes_state;
+
+extern ast_passes_state save_ast_passes(void);
+extern void restore_ast_passes(const ast_passes_state *state);
 
 extern void print_ast(const ast_node *ast);
 
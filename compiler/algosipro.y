@@ -8,11 +8,6 @@
     #include "compiler.h"
 	#include "utils.h"
 
-    static algorithms_map *g_algs_map;
-    static algorithm *g_current_alg;
-    static variables_map *g_current_vars;
-	static ast_node *first_call;
-
 	#define ARGS_DATA_BUF_INIT 2
 	#define ARGS_DATA_BUF_MUL 2
 
@@ -23,18 +18,64 @@
 		ast_node **params;
 		int params_count;
 		int __buff_size;
+		struct args_data *previous;	// Liste en cours de construction englobante
+	};
+%}
+
+%code requires {
+	#include "ast.h"
+	#include "algorithms.h"
+	#include "mapped_file.h"
+
+	#ifndef YY_TYPEDEF_YY_SCANNER_T
+	#define YY_TYPEDEF_YY_SCANNER_T
+	typedef void *yyscan_t;
+	#endif
+
+	// État de l'analyse d'un programme, propre à chaque appel de yyparse
+	struct parse_context {
+		algorithms_map *algs;
+		algorithm *current_alg;         // NULL hors d'une définition d'algorithme
+		variables_map *current_vars;
+		ast_node *main_call;
+		yyscan_t scanner;               // NULL hors de l'analyse
+		mapped_file input;              // Projection du fichier lu, s'il y en a un
+		struct args_data *args;         // Listes d'arguments en cours, la plus interne d'abord
 	};
+}
+
+%code provides {
+	// Analyse source (ou, s'il est NULL, le fichier path, ou l'entrée standard
+	//   si path est aussi NULL) dans ctx->algs. Les erreurs passent par
+	//   report_error
+	void parse_program(struct parse_context *ctx, const char *path, const char *source, size_t size);
+	// Libère l'analyseur lexical et les listes d'arguments en cours, y compris
+	//   après une erreur en cours d'analyse
+	void end_parse(struct parse_context *ctx);
+}
+
+%code {
+	// Analyseur lexical réentrant (flex)
+	int yylex(YYSTYPE *yylval_param, YYLTYPE *yylloc_param, yyscan_t scanner);
+	int yylex_init(yyscan_t *scanner);
+	int yylex_destroy(yyscan_t scanner);
+	void scan_file(yyscan_t scanner, const char *path, mapped_file *input);
+	void scan_memory(yyscan_t scanner, const char *source, size_t size);
+	void end_scan(yyscan_t scanner, mapped_file *input);
 
-	// Prototypes
-	int yylex();
-	void yyerror(char const *);
+	void yyerror(YYLTYPE *loc, yyscan_t scanner, struct parse_context *ctx, char const *s);
 
-	struct args_data *args_data_empty();
+	// Listes d'arguments des appels
+	struct args_data *args_data_empty(struct parse_context *ctx);
 	void args_data_add(struct args_data *args, ast_node *expr);
-%}
+	void args_data_free(struct parse_context *ctx, struct args_data *args);
+}
 
 %locations
+%define api.pure full
 %define parse.error verbose
+%param {yyscan_t scanner}
+%parse-param {struct parse_context *ctx}
 
 %union {
 	int int_value;
@@ -43,7 +84,7 @@
     struct ast_node* node_type;
 	struct args_data* args;
 
-	char symbol[256];
+	const char *symbol; // Interné par le lexer
 }
 
 %token START
@@ -98,7 +139,7 @@
 // Fichier de code complet
 FULL_CODE:
 	ALGOS FUNCTION_CALL {
-		first_call = $2;
+		ctx->main_call = $2;
 	}
 ;
 
@@ -110,21 +151,25 @@ ALGOS:
 // Définition d'un algorithme (Fonction)
 ALGO:
 	 START '{' NEW_FUNC_NAME '}' '{' PARAMS_LIST '}' BLOCK END {
-		ast_node *new_function = make_function(get_alg_name(g_current_alg), $8);
+		ast_node *new_function = make_function(get_alg_name(ctx->current_alg), $8);
 		LS(new_function, @1);
-        associate_tree(g_current_alg, new_function);
+        associate_tree(ctx->current_alg, new_function);
+        ctx->current_alg = NULL;
+        ctx->current_vars = NULL;
+        set_ast_arena(get_algs_arena(ctx->algs));
 	}
 ;
 
 NEW_FUNC_NAME:
 	 SYMBOL {
-        g_current_alg = create_algorithm(g_algs_map, $1);
-        g_current_vars = get_alg_variables(g_current_alg);
+        ctx->current_alg = create_algorithm(ctx->algs, $1);
+        ctx->current_vars = get_alg_variables(ctx->current_alg);
+        set_ast_arena(get_alg_arena(ctx->current_alg));
 	}
 ;
 
 PARAMS_LIST:
-	| SYMBOL	 						{ create_parameter(g_current_vars, $1); }
+	| SYMBOL	 						{ create_parameter(ctx->current_vars, $1); }
 	| PARAMS_LIST ',' PARAMS_LIST	 	{ ; }
 ;
 
@@ -136,7 +181,7 @@ BLOCK:
 
 NON_EMPTY_BLOCK:
 	  STATEMENT						{ $$ = $1; LS($$, @1); }
-	| STATEMENT NON_EMPTY_BLOCK		{ $$ = make_sequence($1, $2); LS($$, @1); }
+	| NON_EMPTY_BLOCK STATEMENT		{ $$ = append_statement($1, $2); }
 ;
 
 EPSILON:
@@ -144,8 +189,8 @@ EPSILON:
 STATEMENT:
       INST_SET '{' SYMBOL '}' '{' EXPR '}' {
         $$ = make_assignement($3, $6);
-        if (!variable_exists(g_current_vars, $3)) {
-            create_local(g_current_vars, $3);
+        if (!variable_exists(ctx->current_vars, $3)) {
+            create_local(ctx->current_vars, $3);
         }
 		LS($$, @1);
       }
@@ -208,12 +253,16 @@ FUNCTION_CALL:
 	  INST_CALL '{' SYMBOL '}' '{' ARGS_LIST '}' {
 		$$ = make_call($3, $6->params, $6->params_count);
 		LS($$, @1);
+		args_data_free(ctx, $6);
+		if (ctx->current_alg != NULL) {
+			add_call_edge(get_call_graph(ctx->algs), get_alg_name(ctx->current_alg), $3);
+		}
 	}
 
 ARGS_LIST:
-	  { $$ = args_data_empty(); }
+	  { $$ = args_data_empty(ctx); }
 	| EXPR {
-		$$ = args_data_empty();
+		$$ = args_data_empty(ctx);
 		args_data_add($$, $1);
 	}
 	| ARGS_LIST ',' EXPR {
@@ -223,47 +272,74 @@ ARGS_LIST:
 
 %%
 
-extern int yylineno;
-
-void yyerror(char const *s) {
-	fprintf(stderr, "%s\n", s);
-	exit(EXIT_FAILURE);
+void yyerror(YYLTYPE *loc, [[ maybe_unused ]] yyscan_t scanner, [[ maybe_unused ]] struct parse_context *ctx, char const *s) {
+	report_error(loc->first_line, "%s\n", s);
 }
 
-int main(int argc, char *argv[]) {
-    g_algs_map = create_algorithms_map();
-    g_current_alg = NULL;
-    g_current_vars = NULL;
-
-	yyparse();
-
-    compile_code(argc, argv, g_algs_map, first_call);
-
-	return EXIT_SUCCESS;
+void parse_program(struct parse_context *ctx, const char *path, const char *source, size_t size) {
+	if (yylex_init(&ctx->scanner) != 0) {
+		ctx->scanner = NULL;
+		ERROR("Could not allocate the scanner\n");
+	}
+	// Sans code ni fichier, le code est lu sur l'entrée standard
+	if (source != NULL) {
+		scan_memory(ctx->scanner, source, size);
+	} else if (path != NULL) {
+		scan_file(ctx->scanner, path, &ctx->input);
+	}
+	set_ast_arena(get_algs_arena(ctx->algs));
+	yyparse(ctx->scanner, ctx);
+	end_parse(ctx);
 }
 
+void end_parse(struct parse_context *ctx) {
+	// Une erreur de syntaxe quitte yyparse sans libérer sa pile
+	while (ctx->args != NULL) {
+		args_data_free(ctx, ctx->args);
+	}
+	if (ctx->scanner == NULL) {
+		return;
+	}
+	end_scan(ctx->scanner, ctx->input.data != NULL ? &ctx->input : NULL);
+	ctx->input = (mapped_file) { NULL, 0, 0 };
+	yylex_destroy(ctx->scanner);
+	ctx->scanner = NULL;
+}
 
-struct args_data *args_data_empty() {
+// Les listes s'emboîtent comme les appels : la dernière créée est la
+//   première libérée
+struct args_data *args_data_empty(struct parse_context *ctx) {
 	struct args_data *ret = malloc(sizeof *ret);
 	if (ret == NULL) {
 		ERROR("Could not allocate\n");
 	}
 	ret->params = malloc(ARGS_DATA_BUF_INIT * sizeof *ret->params);
 	if (ret->params == NULL) {
+		free(ret);
 		ERROR("Could not allocate\n");
 	}
 	ret->__buff_size = ARGS_DATA_BUF_INIT;
 	ret->params_count = 0;
+	ret->previous = ctx->args;
+	ctx->args = ret;
 	return ret;
 }
 
+void args_data_free(struct parse_context *ctx, struct args_data *args) {
+	ctx->args = args->previous;
+	free(args->params);
+	free(args);
+}
+
 void args_data_add(struct args_data *args, ast_node *expr) {
 	if (args->params_count == args->__buff_size) {
-		args->__buff_size *= ARGS_DATA_BUF_MUL;
-		args->params = realloc(args->params, (size_t)args->__buff_size * sizeof *args->params);
-		if (args->params == NULL) {
+		// En cas d'échec, l'ancien tableau reste libéré par end_parse
+		ast_node **params = realloc(args->params, (size_t)args->__buff_size * ARGS_DATA_BUF_MUL * sizeof *args->params);
+		if (params == NULL) {
 			ERROR("Could not allocate\n");
 		}
+		args->params = params;
+		args->__buff_size *= ARGS_DATA_BUF_MUL;
 	}
 	args->params[args->params_count++] = expr;
 }
@@ -0,0 +1,145 @@
+#define _POSIX_C_SOURCE 200809L // getline
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "batch.h"
+#include "libalgosipro.h"
+#include "parallel.h"
+#include "utils.h"
+
+#define INPUT_EXTENSION ".algo"
+#define OUTPUT_EXTENSION ".asipro"
+#define MANIFEST_COMMENT '#'
+
+#define PATHS_BUF_MUL 2
+
+typedef struct {
+    const compile_options *options;
+    const char **paths;
+    atomic_int failures;
+} batch;
+
+// Les messages d'un fichier ne s'entremêlent pas avec ceux des autres
+static pthread_mutex_t g_stderr_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static const char **read_manifest(const char *manifest_path, const char **paths, int *count, int *size);
+static char *output_path(const char *input_path);
+static int compile_file(const compile_options *options, const char *path);
+static void compile_file_task(int index, void *context);
+
+int compile_batch(const compile_options *options, const char **input_paths, int input_count, const char *manifest_path) {
+    int count = input_count;
+    int size = count > 0 ? count : 1;
+    const char **paths = cralloc((size_t) size * sizeof *paths);
+    memcpy(paths, input_paths, (size_t) count * sizeof *paths);
+    if (manifest_path != NULL) {
+        paths = read_manifest(manifest_path, paths, &count, &size);
+    }
+
+    // Une erreur de compilation est rattrapée par compile_file : les autres
+    //   fichiers sont compilés
+    batch b = { .options = options, .paths = paths };
+    atomic_init(&b.failures, 0);
+    parallel_for(count, options->jobs, compile_file_task, &b);
+
+    // Seuls les chemins de la liste ont été alloués
+    for (int i = input_count; i < count; ++i) {
+        free((char *) paths[i]);
+    }
+    free(paths);
+    return atomic_load(&b.failures);
+}
+
+// Ajoute à paths les chemins listés, sans les lignes vides ni les commentaires
+const char **read_manifest(const char *manifest_path, const char **paths, int *count, int *size) {
+    FILE *manifest = fopen(manifest_path, "r");
+    if (manifest == NULL) {
+        ERRORF("Could not read file list '%s'\n", manifest_path);
+    }
+    char *line = NULL;
+    size_t capacity = 0;
+    ssize_t length;
+    while ((length = getline(&line, &capacity, manifest)) != -1) {
+        while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) {
+            line[--length] = '\0';
+        }
+        if (length == 0 || line[0] == MANIFEST_COMMENT) {
+            continue;
+        }
+        if (*count == *size) {
+            *size *= PATHS_BUF_MUL;
+            paths = realloc(paths, (size_t) *size * sizeof *paths);
+            if (paths == NULL) {
+                ERROR("Could not allocate\n");
+            }
+        }
+        // La ligne garde son tampon, getline en allouera un nouveau
+        paths[(*count)++] = line;
+        line = NULL;
+        capacity = 0;
+    }
+    free(line);
+    fclose(manifest);
+    return paths;
+}
+
+// input.algo -> input.asipro, autre.ext -> autre.ext.asipro
+char *output_path(const char *input_path) {
+    size_t length = strlen(input_path);
+    size_t extension_length = strlen(INPUT_EXTENSION);
+    if (length > extension_length && strcmp(input_path + length - extension_length, INPUT_EXTENSION) == 0) {
+        length -= extension_length;
+    }
+    char *result = cralloc(length + strlen(OUTPUT_EXTENSION) + 1);
+    memcpy(result, input_path, length);
+    strcpy(result + length, OUTPUT_EXTENSION);
+    return result;
+}
+
+// Renvoie 1 si le fichier a été compilé. Un fichier en erreur ne laisse pas
+//   de code partiel
+int compile_file(const compile_options *options, const char *path) {
+    char *out_path = output_path(path);
+    diagnostic diag;
+    algosipro_status status = ALGOSIPRO_ERROR;
+
+    FILE *output = fopen(out_path, "w");
+    if (output == NULL) {
+        diag = (diagnostic) { .line = -1 };
+        snprintf(diag.message, sizeof diag.message, "Could not write output file '%s'\n", out_path);
+    } else {
+        compile_options file_options = *options;
+        file_options.input_path = path;
+        file_options.output = output;
+        // Les threads sont déjà occupés par les autres fichiers
+        file_options.jobs = 1;
+        status = algosipro_compile_stream(&file_options, NULL, 0, &diag);
+        if (fclose(output) != 0 && status == ALGOSIPRO_OK) {
+            status = ALGOSIPRO_ERROR;
+            diag = (diagnostic) { .line = -1 };
+            snprintf(diag.message, sizeof diag.message, "Could not write output file '%s'\n", out_path);
+        }
+        if (status != ALGOSIPRO_OK) {
+            remove(out_path);
+        }
+    }
+
+    if (status != ALGOSIPRO_OK) {
+        pthread_mutex_lock(&g_stderr_lock);
+        fprintf(stderr, BOLD "%s: " RESET, path);
+        print_diagnostic(stderr, &diag);
+        pthread_mutex_unlock(&g_stderr_lock);
+    }
+    free(out_path);
+    return status == ALGOSIPRO_OK;
+}
+
+void compile_file_task(int index, void *context) {
+    batch *b = context;
+    if (!compile_file(b->options, b->paths[index])) {
+        atomic_fetch_add(&b->failures, 1);
+    }
+}
@@ -0,0 +1,13 @@
+#ifndef BATCH__H
+#define BATCH__H
+
+#include "compiler.h"
+
+// Compile les input_count fichiers d'input_paths puis ceux de la liste
+//   manifest_path (NULL : aucune) sur options->jobs threads. Chaque
+//   input.algo est compilé dans input.asipro, à côté de lui ; les erreurs sont
+//   affichées sur la sortie d'erreur, préfixées par le fichier. Renvoie le
+//   nombre de fichiers non compilés
+extern int compile_batch(const compile_options *options, const char **input_paths, int input_count, const char *manifest_path);
+
+#endif
@@ -0,0 +1,199 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libalgosipro.h"
+#include "batch.h"
+#include "intern.h"
+#include "utils.h"
+
+#define ARG_NONE 0
+#define ARG_HELP 1
+#define ARG_DEBUG 2
+#define ARG_NO_CODE 3
+#define ARG_NO_OPTIMIZATION 4
+#define ARG_MEMOIZE 5
+#define ARG_REMARKS 6
+#define ARG_CHECK_ALL 7
+#define ARG_JOBS 8
+#define ARG_MANIFEST 9
+
+#define ARG_HELP_STR "-h"
+#define ARG_DEBUG_STR "-d"
+#define ARG_NO_CODE_STR "-c"
+#define ARG_NO_OPTIMIZATION_STR "-o"
+#define ARG_MEMOIZE_STR "-m"
+#define ARG_REMARKS_STR "-r"
+#define ARG_CHECK_ALL_STR "-a"
+#define ARG_JOBS_STR "-j"
+#define ARG_MANIFEST_STR "-l"
+
+// Options de la ligne de commande : celles d'une compilation, et ce qui ne
+//   concerne que l'exécutable
+typedef struct {
+    compile_options compile;
+    const char *exec_name;
+    const char **input_paths;   // Fichiers en argument, dans l'ordre
+    int input_count;
+    const char *manifest_path;  // Liste de fichiers, un par ligne, NULL sinon
+    int help;
+} cli_options;
+
+static void parse_cli_options(int argc, char *argv[], cli_options *options);
+static void analyze_arg(const char *argstr, cli_options *options);
+static int analyze_valued_arg(const char *argstr, const char *value, cli_options *options);
+static void print_help(const char *exec_name);
+static int run(const cli_options *options);
+
+int main(int argc, char *argv[]) {
+    cli_options options;
+    parse_cli_options(argc, argv, &options);
+    int status = run(&options);
+    free(options.input_paths);
+    // Plus aucune compilation n'est en cours
+    dispose_interned();
+    return status;
+}
+
+int run(const cli_options *options) {
+    if (options->help) {
+        print_help(options->exec_name);
+        return EXIT_SUCCESS;
+    }
+
+    // Plusieurs fichiers : chacun dans son propre .asipro, en parallèle
+    if (options->input_count > 1 || options->manifest_path != NULL) {
+        int failures = compile_batch(&options->compile, options->input_paths, options->input_count, options->manifest_path);
+        return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    diagnostic diag;
+    if (algosipro_compile_stream(&options->compile, NULL, 0, &diag) != ALGOSIPRO_OK) {
+        print_diagnostic(stderr, &diag);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+// Une option invalide termine le programme (ERRORF)
+void parse_cli_options(int argc, char *argv[], cli_options *options) {
+    *options = (cli_options) {
+        .compile = { .input_path = NULL, .output = stdout, .jobs = 0 },
+        .exec_name = argv[0],
+        .input_paths = cralloc((size_t) argc * sizeof *options->input_paths),
+        .input_count = 0,
+        .manifest_path = NULL,
+        .help = 0,
+    };
+    for (int i = 1; i < argc; ++i) {
+        // Seuls arguments qui ne sont pas des options : les fichiers à compiler
+        if (argv[i][0] != '-') {
+            options->input_paths[options->input_count++] = argv[i];
+            continue;
+        }
+        if (analyze_valued_arg(argv[i], i + 1 < argc ? argv[i + 1] : NULL, options)) {
+            ++i;
+            continue;
+        }
+        analyze_arg(argv[i], options);
+    }
+    if (options->input_count == 1) {
+        options->compile.input_path = options->input_paths[0];
+    }
+}
+
+void print_help(const char *exec_name) {
+    printf("Usage: %s [options] [input.algo...]\n", exec_name);
+    printf("\t" ARG_DEBUG_STR ": Show debug information on standard output\n");
+    printf("\t" ARG_NO_CODE_STR ": Do not print output code, useful to debug\n");
+    printf("\t" ARG_NO_OPTIMIZATION_STR ": Do not run any optimization code, compile as code is written\n");
+    printf("\t" ARG_MEMOIZE_STR ": Memoize pure recursive algorithms whose parameters take few values (needs optimization)\n");
+    printf("\t" ARG_REMARKS_STR ": Print optimizer remarks (rewritten idioms) on standard error\n");
+    printf("\t" ARG_CHECK_ALL_STR ": Also type-check and check algorithms that are never called\n");
+    printf("\t" ARG_MANIFEST_STR " list: Also compile the files listed in list, one path per line ('#' starts a comment line)\n");
+    printf("\t" ARG_JOBS_STR " n: Use n threads (default: one per processor), for the files or for the algorithms of a single file\n");
+    printf("\t" ARG_HELP_STR ": Show help\n");
+    printf("\tWithout input file, the code is read on standard input: %s < input.algo > output.asipro\n", exec_name);
+    printf("\tWith a single input file, the code is written on standard output: %s input.algo > output.asipro\n", exec_name);
+    printf("\tWith several input files or a list, each input.algo is compiled to input.asipro, next to it\n");
+}
+
+void analyze_arg(const char *argstr, cli_options *options) {
+    int arg = ARG_NONE;
+
+    if (strcmp(argstr, ARG_DEBUG_STR) == 0) {
+        arg = ARG_DEBUG;
+    } else if (strcmp(argstr, ARG_NO_CODE_STR) == 0) {
+        arg = ARG_NO_CODE;
+    } else if (strcmp(argstr, ARG_HELP_STR) == 0) {
+        arg = ARG_HELP;
+    } else if (strcmp(argstr, ARG_NO_OPTIMIZATION_STR) == 0) {
+        arg = ARG_NO_OPTIMIZATION;
+    } else if (strcmp(argstr, ARG_MEMOIZE_STR) == 0) {
+        arg = ARG_MEMOIZE;
+    } else if (strcmp(argstr, ARG_REMARKS_STR) == 0) {
+        arg = ARG_REMARKS;
+    } else if (strcmp(argstr, ARG_CHECK_ALL_STR) == 0) {
+        arg = ARG_CHECK_ALL;
+    }
+
+    switch (arg) {
+        case ARG_DEBUG:
+            options->compile.debug = 1;
+            break;
+        case ARG_NO_CODE:
+            options->compile.no_code = 1;
+            break;
+        case ARG_NO_OPTIMIZATION:
+            options->compile.no_optimization = 1;
+            break;
+        case ARG_MEMOIZE:
+            options->compile.memoize = 1;
+            break;
+        case ARG_REMARKS:
+            options->compile.remarks = 1;
+            break;
+        case ARG_CHECK_ALL:
+            options->compile.check_all = 1;
+            break;
+        case ARG_HELP:
+            options->help = 1;
+            break;
+        default:
+            break;
+    }
+}
+
+// Renvoie 1 si l'option consomme value
+int analyze_valued_arg(const char *argstr, const char *value, cli_options *options) {
+    int arg = ARG_NONE;
+
+    if (strcmp(argstr, ARG_JOBS_STR) == 0) {
+        arg = ARG_JOBS;
+    } else if (strcmp(argstr, ARG_MANIFEST_STR) == 0) {
+        arg = ARG_MANIFEST;
+    } else {
+        return 0;
+    }
+    if (value == NULL) {
+        ERRORF("Option %s expects a value\n", argstr);
+    }
+
+    switch (arg) {
+        case ARG_JOBS: {
+            char *end;
+            long jobs = strtol(value, &end, 10);
+            if (*end != '\0' || jobs <= 0 || jobs > INT_MAX) {
+                ERRORF("Option %s expects a positive number of threads, got '%s'\n", argstr, value);
+            }
+            options->compile.jobs = (int) jobs;
+            break;
+        }
+        case ARG_MANIFEST:
+            options->manifest_path = value;
+            break;
+        default:
+            break;
+    }
+    return 1;
+}
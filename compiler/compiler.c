@@ -1,100 +1,147 @@
+#include <setjmp.h>
 #include "compiler.h"
+#include "diagnostic.h"
+#include "parallel.h"
 
-#define ARG_NONE 0
-#define ARG_HELP 1
-#define ARG_DEBUG 2
-#define ARG_NO_CODE 3
-#define ARG_NO_OPTIMIZATION 4
+// En dessous, créer des threads coûte plus qu'il ne rapporte
+#define PARALLEL_MIN_ALGORITHMS 8
 
-#define ARG_HELP_STR "-h"
-#define ARG_DEBUG_STR "-d"
-#define ARG_NO_CODE_STR "-c"
-#define ARG_NO_OPTIMIZATION_STR "-o"
-
-static void print_help_and_exit();
-static void analyze_arg(const char *argstr);
 static void print_alg(const char *alg_name, algorithm *alg);
 
 static void optimize_alg(const char *alg_name, algorithm *alg);
 static void check_code(const char *alg_name, algorithm *alg);
+static void check_unreachable_code(const char *alg_name, algorithm *alg);
 
 static void debug_print_part(algorithms_map *algs, int should_print_part_title, const char *part_title);
 
-static int g_debug = 0;
-static int g_no_code = 0;
-static int g_no_optimization = 0;
+static int phase_jobs(algorithms_map *algs);
+static void foreach_algorithm_parallel(algorithms_map *algs, int bottom_up, void (*callback)(const char *alg_name, algorithm *alg));
 
-static const char *g_exec_name;
+// Compilation en cours dans ce thread, lue par les fonctions de parcours
+static _Thread_local const compile_options *g_options;
+static _Thread_local algorithms_map *g_algs_map;
 
-static algorithms_map *g_algs_map;
+int compile_code(const compile_options *options, algorithms_map *algs_map, ast_node *first_call) {
+    g_options = options;
+    g_algs_map = algs_map;
 
-int compile_code(int argc, char *argv[], algorithms_map *algs_map, ast_node *first_call) {
-    g_exec_name = argv[0];
-    for (int i = 1; i < argc; ++i) {
-        analyze_arg(argv[i]);
+    // Les algorithmes jamais appelés ne sont ni optimisés ni écrits
+    mark_reachable_algorithms(algs_map, first_call);
+    if (!options->check_all) {
+        remove_unreachable_algorithms(algs_map);
     }
 
-    g_algs_map = algs_map;
+    if (!options->no_optimization) {
+        debug_print_part(algs_map, 1, "Idioms recognition");
+        recognize_idioms(algs_map, options->debug, options->remarks);
+    }
+
+    // Arbres construits de bas en haut par le parser : rangés en préordre
+    compact_ast_trees(algs_map);
 
     debug_print_part(algs_map, 1, "Type resolving");
     resolve_types(algs_map);
 
-    if (!g_no_optimization) {
+    if (options->check_all) {
+        debug_print_part(algs_map, 1, "Unreachable code checking");
+        foreach_algorithm(algs_map, check_unreachable_code);
+        remove_unreachable_algorithms(algs_map);
+    }
+
+    debug_print_part(algs_map, 1, "Effects analysis");
+    analyze_effects(algs_map, options->debug);
+
+    if (!options->no_optimization) {
+        debug_print_part(algs_map, 1, "Dead arguments");
+        eliminate_dead_arguments(algs_map, first_call, options->debug);
+
         debug_print_part(algs_map, 1, "Optimizing code");
-        foreach_algorithm(algs_map, optimize_alg);
+        foreach_algorithm_parallel(algs_map, 1, optimize_alg);
     }
 
     debug_print_part(algs_map, 1, "Code checking");
-    foreach_algorithm(algs_map, check_code);
+    foreach_algorithm_parallel(algs_map, 0, check_code);
+
+    if (!options->no_optimization) {
+        debug_print_part(algs_map, 1, "Value ranges");
+        int folded = analyze_value_ranges(algs_map, first_call, options->debug);
+        if (analyze_effects(algs_map, options->debug) > 0 || folded > 0) {
+            foreach_algorithm_parallel(algs_map, 1, optimize_alg);
+        }
+        if (options->memoize) {
+            memoize_algorithms(algs_map, options->debug);
+        }
+        dispose_value_ranges();
+    }
 
-    debug_print_part(algs_map, !g_no_code, "Output code");
-    if (!g_no_code) {
-        write_all_instructions(algs_map, first_call);
+    debug_print_part(algs_map, !options->no_code, "Output code");
+    if (!options->no_code) {
+        write_all_instructions(algs_map, first_call, options->output, phase_jobs(algs_map));
     }
 
+    g_options = NULL;
+    g_algs_map = NULL;
     return 0;
 }
 
 
-void print_help_and_exit() {
-    printf("Usage: %s\n", g_exec_name);
-    printf("\t" ARG_DEBUG_STR ": Show debug information on standard output\n");
-    printf("\t" ARG_NO_CODE_STR ": Do not print output code, useful to debug\n");
-    printf("\t" ARG_NO_OPTIMIZATION_STR ": Do not run any optimization code, compile as code is written\n");
-    printf("\t" ARG_HELP_STR ": Show help\n");
-    printf("\tTo compile to a file, redirect: %s < input.algo > output.asipro\n", g_exec_name);
-    exit(0);
+// Les traces (-d, -r) restent dans l'ordre d'une compilation séquentielle
+int phase_jobs(algorithms_map *algs) {
+    if (g_options->debug || g_options->remarks || algorithms_count(algs) < PARALLEL_MIN_ALGORITHMS) {
+        return 1;
+    }
+    return g_options->jobs;
 }
 
-void analyze_arg(const char *argstr) {
-    int arg = ARG_NONE;
-    
-    if (strcmp(argstr, ARG_DEBUG_STR) == 0) {
-        arg = ARG_DEBUG;
-    } else if (strcmp(argstr, ARG_NO_CODE_STR) == 0) {
-        arg = ARG_NO_CODE;
-    } else if (strcmp(argstr, ARG_HELP_STR) == 0) {
-        arg = ARG_HELP;
-    } else if (strcmp(argstr, ARG_NO_OPTIMIZATION_STR) == 0) {
-        arg = ARG_NO_OPTIMIZATION;
-    }
-    
-    switch (arg) {
-        case ARG_DEBUG:
-            g_debug = 1;
-            break;
-        case ARG_NO_CODE:
-            g_no_code = 1;
-            break;
-        case ARG_NO_OPTIMIZATION:
-            g_no_optimization = 1;
-            break;
-        case ARG_HELP:
-            print_help_and_exit();
-            break; // Useless
-        default:
-            break;
+// État de la compilation en cours, que le thread d'une tâche n'a pas vu
+struct compilation_state {
+    const compile_options *options;
+    algorithms_map *algs_map;
+    ast_passes_state passes;
+};
+
+static struct compilation_state save_compilation_state(void) {
+    return (struct compilation_state) { g_options, g_algs_map, save_ast_passes() };
+}
+
+static void restore_compilation_state(const struct compilation_state *state) {
+    g_options = state->options;
+    g_algs_map = state->algs_map;
+    restore_ast_passes(&state->passes);
+}
+
+// Passe menée algorithme par algorithme
+struct alg_phase {
+    struct compilation_state state;
+    algorithm **algs;
+    void (*callback)(const char *alg_name, algorithm *alg);
+};
+
+static void alg_phase_task(int index, void *context) {
+    struct alg_phase *phase = context;
+    restore_compilation_state(&phase->state);
+    phase->callback(get_alg_name(phase->algs[index]), phase->algs[index]);
+}
+
+// Une fois les types résolus et les effets analysés, chaque algorithme
+//   n'est plus modifié que par sa propre tâche : répartie sur plusieurs
+//   threads, une erreur reste celle du parcours séquentiel
+void foreach_algorithm_parallel(algorithms_map *algs, int bottom_up, void (*callback)(const char *alg_name, algorithm *alg)) {
+    int count;
+    struct alg_phase phase = { save_compilation_state(), get_algorithms(algs, bottom_up, &count), callback };
+
+    // L'erreur d'une tâche est signalée à nouveau une fois la liste libérée
+    diagnostic error;
+    jmp_buf handler;
+    error_handler previous = set_error_handler(&handler, &error);
+    if (setjmp(handler) != 0) {
+        restore_error_handler(previous);
+        free(phase.algs);
+        report_error(error.line, "%s", error.message);
     }
+    parallel_for(count, phase_jobs(algs), alg_phase_task, &phase);
+    restore_error_handler(previous);
+    free(phase.algs);
 }
 
 void print_alg([[ maybe_unused ]] const char *alg_name, algorithm *alg) {
@@ -103,16 +150,22 @@ void print_alg([[ maybe_unused ]] const char *alg_name, algorithm *alg) {
 }
 
 void optimize_alg([[ maybe_unused ]] const char *alg_name, algorithm *alg) {
-    optimize_ast(g_algs_map, get_alg_tree(alg), g_debug);
+    optimize_ast(g_algs_map, get_alg_tree(alg), g_options->debug);
 }
 
 void check_code([[ maybe_unused ]] const char *alg_name, algorithm *alg) {
     check_ast_code(get_alg_tree(alg), g_algs_map);
 }
 
+void check_unreachable_code(const char *alg_name, algorithm *alg) {
+    if (!is_alg_reachable(alg)) {
+        check_code(alg_name, alg);
+    }
+}
+
 
 void debug_print_part(algorithms_map *algs, int should_print_part_title, const char *part_title) {
-    if (!g_debug) return;
+    if (!g_options->debug) return;
     foreach_algorithm(algs, print_alg);
 
     if (should_print_part_title) {
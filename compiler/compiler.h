@@ -1,10 +1,25 @@
 #ifndef COMPILER__H
 #define COMPILER__H
 
+#include <stdio.h>
 #include "ast.h"
 #include "algorithms.h"
 #include "variables.h"
 
-int compile_code(int argc, char *argv[], algorithms_map *algs_map, ast_node *first_call);
+// Options d'une compilation, plusieurs compilations peuvent s'exécuter en
+//   même temps dans des threads différents
+typedef struct {
+    int debug;
+    int no_code;
+    int no_optimization;
+    int memoize;
+    int remarks;
+    int check_all;
+    const char *input_path;     // NULL : entrée standard
+    FILE *output;               // Code asipro produit
+    int jobs;                   // Threads pour les algorithmes, 0 : un par cœur (voir parallel_for)
+} compile_options;
 
-#endif
\ No newline at end of file
+int compile_code(const compile_options *options, algorithms_map *algs_map, ast_node *first_call);
+
+#endif
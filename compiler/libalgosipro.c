@@ -0,0 +1,95 @@
+// open_memstream
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include "libalgosipro.h"
+#include "algosipro.tab.h"
+
+// Erreurs d'un appelant qui ne les demande pas
+static _Thread_local diagnostic g_ignored_diagnostic;
+
+static void release_compilation(struct parse_context *ctx);
+
+// Erreur détectée hors du gestionnaire : ERROR terminerait le programme
+static algosipro_status compilation_failure(diagnostic *diag, const char *message) {
+    diag->line = -1;
+    snprintf(diag->message, sizeof diag->message, "%s", message);
+    return ALGOSIPRO_ERROR;
+}
+
+algosipro_status algosipro_compile_stream(const compile_options *options,
+        const char *source, size_t size, diagnostic *diag) {
+    if (diag == NULL) {
+        diag = &g_ignored_diagnostic;
+    }
+    // Le contexte est alloué avant setjmp : seul le pointeur, inchangé, est
+    //   relu après longjmp
+    struct parse_context *ctx = malloc(sizeof *ctx);
+    if (ctx == NULL) {
+        return compilation_failure(diag, "Could not allocate the compilation context\n");
+    }
+    *ctx = (struct parse_context) {
+        .algs = NULL,
+        .current_alg = NULL,
+        .current_vars = NULL,
+        .main_call = NULL,
+        .scanner = NULL,
+        .input = { NULL, 0, 0 },
+        .args = NULL,
+    };
+
+    jmp_buf handler;
+    error_handler previous = set_error_handler(&handler, diag);
+    if (setjmp(handler) != 0) {
+        restore_error_handler(previous);
+        // Certaines structures temporaires des passes interrompues restent
+        //   allouées : analyseur, arbres, tables et état des passes sont libérés
+        release_compilation(ctx);
+        return ALGOSIPRO_ERROR;
+    }
+
+    ctx->algs = create_algorithms_map();
+    parse_program(ctx, options->input_path, source, size);
+    compile_code(options, ctx->algs, ctx->main_call);
+
+    restore_error_handler(previous);
+    release_compilation(ctx);
+    return ALGOSIPRO_OK;
+}
+
+algosipro_status algosipro_compile(const compile_options *options,
+        const char *source, size_t size,
+        char *output, size_t capacity, size_t *output_size, diagnostic *diag) {
+    char *buffer = NULL;
+    size_t length = 0;
+    FILE *stream = open_memstream(&buffer, &length);
+    if (stream == NULL) {
+        return compilation_failure(diag != NULL ? diag : &g_ignored_diagnostic,
+                "Could not open the output stream\n");
+    }
+    compile_options stream_options = *options;
+    stream_options.output = stream;
+
+    algosipro_status status = algosipro_compile_stream(&stream_options, source, size, diag);
+    fclose(stream);
+    if (status == ALGOSIPRO_OK) {
+        *output_size = length;
+        if (length >= capacity) {
+            status = ALGOSIPRO_OUTPUT_TOO_SMALL;
+        } else {
+            memcpy(output, buffer, length + 1);
+        }
+    }
+    free(buffer);
+    return status;
+}
+
+void release_compilation(struct parse_context *ctx) {
+    end_parse(ctx);
+    reset_ast_passes();
+    dispose_algorithms_map(&ctx->algs);
+    free(ctx);
+}
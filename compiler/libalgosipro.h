@@ -0,0 +1,34 @@
+#ifndef LIBALGOSIPRO__H
+#define LIBALGOSIPRO__H
+
+#include <stddef.h>
+#include "compiler.h"
+#include "diagnostic.h"
+
+// Bibliothèque du compilateur : plusieurs compilations peuvent s'exécuter en
+//   même temps dans des threads différents, une erreur est renvoyée à
+//   l'appelant au lieu de terminer le programme. Une compilation libère tout
+//   ce qu'elle a alloué, sauf les noms internés (intern.h), partagés avec les
+//   autres compilations : dispose_interned les libère une fois toutes
+//   terminées
+
+typedef enum {
+    ALGOSIPRO_OK,
+    ALGOSIPRO_ERROR,                // *diag décrit l'erreur
+    ALGOSIPRO_OUTPUT_TOO_SMALL,     // *output_size : taille du code produit
+} algosipro_status;
+
+// Compile source, de taille size, dans options->output. Si source est NULL,
+//   lit le fichier options->input_path, ou l'entrée standard. diag peut être
+//   NULL
+extern algosipro_status algosipro_compile_stream(const compile_options *options,
+        const char *source, size_t size, diagnostic *diag);
+
+// Compile source, de taille size, dans le tampon output de taille capacity,
+//   terminé par un octet nul. options->output est ignoré. *output_size reçoit
+//   la taille du code produit, sans l'octet nul
+extern algosipro_status algosipro_compile(const compile_options *options,
+        const char *source, size_t size,
+        char *output, size_t capacity, size_t *output_size, diagnostic *diag);
+
+#endif
@@ -5,25 +5,44 @@
 #define PRINT_START " Debut "
 #define PRINT_END " Fin "
 
+#define ORDERED_BUF_INIT 8
+#define ORDERED_BUF_MUL 2
+
 
 struct algorithm {
-    char *name;
+    const char *name; // Interné
     variables_map *variables;
     value_type return_type;
     ast_node *associated_ast;
+    arena *nodes;       // Nœuds de son arbre, sous-arène de celle de la table
+    int pure;           // Ne peut pas afficher d'erreur
+    int terminating;    // Termine toujours
+    int reachable;      // Appelé, directement ou non, par l'appel principal
 };
 
 struct algorithms_map {
     hashtable *map;
+    // Ordre du code source : les parcours, et donc le code produit, ne
+    //   dépendent pas du hachage des noms
+    algorithm **ordered;
+    int count;
+    int size;
+    call_graph *calls;
+    arena *nodes;       // Appel principal et sous-arènes des algorithmes
 };
 
 
 algorithms_map *create_algorithms_map() {
     algorithms_map *m = cralloc(sizeof *m);
-    m->map = hashtable_empty((cmpfunc) strcmp, (hashfunc) str_hashfun);
+    m->map = hashtable_empty((cmpfunc) interned_cmp, (hashfunc) interned_hash);
     if (m->map == NULL) {
         ERROR("Could not allocate algorithms map\n");
     }
+    m->size = ORDERED_BUF_INIT;
+    m->ordered = cralloc((size_t) m->size * sizeof *m->ordered);
+    m->count = 0;
+    m->calls = create_call_graph();
+    m->nodes = arena_create(NULL);
     return m;
 }
 
@@ -35,24 +54,90 @@ algorithm *get_algorithm(const algorithms_map *map, const char *alg_name) {
     return alg;
 }
 
+algorithm *find_algorithm(const algorithms_map *map, const char *alg_name) {
+    return hashtable_search(map->map, alg_name);
+}
+
 algorithm *create_algorithm(algorithms_map *map, const char *name) {
+    if (find_algorithm(map, name) != NULL) {
+        ERRORF("Cannot create algorithm, name '%s' is already used\n", name);
+    }
     algorithm *alg = cralloc(sizeof *alg);
-    alg->name = cralloc(strlen(name) + 1);
-    strcpy(alg->name, name);
+    alg->name = name;
     alg->variables = create_variables_map();
     alg->return_type = TYPE_UNKNOWN;
     alg->associated_ast = NULL;
+    alg->nodes = arena_create(map->nodes);
+    alg->pure = 0;
+    alg->terminating = 0;
+    alg->reachable = 0;
 
     hashtable_add(map->map, alg->name, alg);
+    if (map->count == map->size) {
+        map->size *= ORDERED_BUF_MUL;
+        map->ordered = realloc(map->ordered, (size_t) map->size * sizeof *map->ordered);
+        if (map->ordered == NULL) {
+            ERROR("Could not allocate algorithms map\n");
+        }
+    }
+    map->ordered[map->count++] = alg;
+    add_call_graph_node(map->calls, alg->name);
     return alg;
 }
 
+arena *get_algs_arena(const algorithms_map *map) {
+    return map->nodes;
+}
+
+arena *get_alg_arena(const algorithm *alg) {
+    return alg->nodes;
+}
+
+arena *replace_alg_arena(algorithm *alg, arena *nodes) {
+    arena *previous = alg->nodes;
+    alg->nodes = nodes;
+    return previous;
+}
+
+static void forget_tree([[ maybe_unused ]] const char *alg_name, algorithm *alg) {
+    alg->associated_ast = NULL;
+    alg->nodes = NULL;
+}
+
+void free_all_trees(algorithms_map *map) {
+    foreach_algorithm(map, forget_tree);
+    arena_dispose(&map->nodes);
+}
+
+static void dispose_algorithm([[ maybe_unused ]] const char *alg_name, algorithm *alg) {
+    arena_dispose(&alg->nodes);
+    dispose_variables_map(&alg->variables);
+    free(alg);
+}
+
+void dispose_algorithms_map(algorithms_map **map) {
+    if (*map == NULL) return;
+    // Les arènes des algorithmes sont des sous-arènes de celle de la table :
+    //   libérées avec elle, elles ne le sont plus une seconde fois
+    free_all_trees(*map);
+    foreach_algorithm(*map, dispose_algorithm);
+    hashtable_dispose(&(*map)->map);
+    free((*map)->ordered);
+    dispose_call_graph(&(*map)->calls);
+    free(*map);
+    *map = NULL;
+}
+
+call_graph *get_call_graph(const algorithms_map *map) {
+    return map->calls;
+}
+
 void associate_tree(algorithm *alg, ast_node *tree) {
     alg->associated_ast = tree;
 }
 
 const char *get_alg_name(const algorithm *alg) {
-    return (const char *) alg->name;
+    return alg->name;
 }
 
 ast_node *get_alg_tree(const algorithm *alg) {
@@ -67,6 +152,46 @@ variables_map *get_alg_variables(const algorithm *alg) {
     return alg->variables;
 }
 
+int is_alg_pure(const algorithm *alg) {
+    return alg->pure;
+}
+
+int is_alg_terminating(const algorithm *alg) {
+    return alg->terminating;
+}
+
+void set_alg_effects(algorithm *alg, int pure, int terminating) {
+    alg->pure = pure;
+    alg->terminating = terminating;
+}
+
+int is_alg_reachable(const algorithm *alg) {
+    return alg->reachable;
+}
+
+void set_alg_reachable(algorithm *alg, int reachable) {
+    alg->reachable = reachable;
+}
+
+int remove_unreachable_algorithms(algorithms_map *map) {
+    // Les algorithmes gardés restent dans l'ordre du code source
+    int kept = 0;
+    for (int i = 0; i < map->count; ++i) {
+        algorithm *alg = map->ordered[i];
+        if (alg->reachable) {
+            map->ordered[kept++] = alg;
+            continue;
+        }
+        hashtable_remove(map->map, alg->name);
+        arena_dispose(&alg->nodes);
+        dispose_variables_map(&alg->variables);
+        free(alg);
+    }
+    int removed = map->count - kept;
+    map->count = kept;
+    return removed;
+}
+
 value_type unify_return_type(algorithm *alg, value_type return_type) {
     if (return_type == TYPE_UNKNOWN) {
         return alg->return_type;
@@ -85,7 +210,47 @@ static void print_var(const char *var_name, variable *var) {
 }
 
 void foreach_algorithm(algorithms_map *map, void (*callback)(const char *alg_name, algorithm *alg)) {
-    hashtable_foreach(map->map, (void (*)(const void *, const void *)) callback);
+    for (int i = 0; i < map->count; ++i) {
+        callback(map->ordered[i]->name, map->ordered[i]);
+    }
+}
+
+void foreach_algorithm_bottom_up(algorithms_map *map, void (*callback)(const char *alg_name, algorithm *alg)) {
+    int count;
+    const char **order = call_graph_order(map->calls, &count);
+    for (int i = 0; i < count; ++i) {
+        // Les algorithmes retirés (inaccessibles) restent dans le graphe
+        algorithm *alg = hashtable_search(map->map, order[i]);
+        if (alg != NULL) {
+            callback(alg->name, alg);
+        }
+    }
+}
+
+static _Thread_local algorithm **g_collected;
+static _Thread_local int g_collected_count;
+
+static void collect_algorithm([[ maybe_unused ]] const char *alg_name, algorithm *alg) {
+    g_collected[g_collected_count++] = alg;
+}
+
+int algorithms_count(const algorithms_map *map) {
+    return map->count;
+}
+
+algorithm **get_algorithms(algorithms_map *map, int bottom_up, int *count) {
+    algorithm **algs = cralloc(((size_t) map->count + 1) * sizeof *algs);
+    if (!bottom_up) {
+        memcpy(algs, map->ordered, (size_t) map->count * sizeof *algs);
+        *count = map->count;
+        return algs;
+    }
+    g_collected = algs;
+    g_collected_count = 0;
+    foreach_algorithm_bottom_up(map, collect_algorithm);
+    g_collected = NULL;
+    *count = g_collected_count;
+    return algs;
 }
 
 void print_algorithm(const algorithm *alg) {
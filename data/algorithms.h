@@ -10,12 +10,22 @@ typedef struct algorithms_map algorithms_map;
 #include "hashtable.h"
 #include "ast.h"
 #include "variables.h"
+#include "callgraph.h"
+#include "arena.h"
 #include "utils.h"
 
+// Les noms d'algorithmes sont internés (intern) : comparés par pointeur
 extern algorithms_map *create_algorithms_map();
+extern void dispose_algorithms_map(algorithms_map **map); // Arbres, algorithmes et variables
 extern algorithm *get_algorithm(const algorithms_map *map, const char *alg_name);
+extern algorithm *find_algorithm(const algorithms_map *map, const char *alg_name); // NULL si inexistant
 
 extern algorithm *create_algorithm(algorithms_map *map, const char *name);
+extern arena *get_algs_arena(const algorithms_map *map);
+extern arena *get_alg_arena(const algorithm *alg);
+extern arena *replace_alg_arena(algorithm *alg, arena *nodes); // Renvoie l'ancienne
+extern void free_all_trees(algorithms_map *map); // Libère tous les nœuds en une fois
+extern call_graph *get_call_graph(const algorithms_map *map); // Arêtes ajoutées par le parseur
 extern void associate_tree(algorithm *alg, ast_node *tree);
 
 extern const char *get_alg_name(const algorithm *alg);
@@ -23,9 +33,23 @@ extern ast_node *get_alg_tree(const algorithm *alg);
 extern value_type get_return_type(const algorithm *alg);
 extern variables_map *get_alg_variables(const algorithm *alg);
 
+// Résumés calculés par analyze_effects, faux tant que non prouvés
+extern int is_alg_pure(const algorithm *alg);
+extern int is_alg_terminating(const algorithm *alg);
+extern void set_alg_effects(algorithm *alg, int pure, int terminating);
+
+// Calculé par mark_reachable_algorithms depuis l'appel principal
+extern int is_alg_reachable(const algorithm *alg);
+extern void set_alg_reachable(algorithm *alg, int reachable);
+extern int remove_unreachable_algorithms(algorithms_map *map); // Nombre d'algorithmes retirés
+
 extern value_type unify_return_type(algorithm *alg, value_type return_type);
 
-extern void foreach_algorithm(algorithms_map *map, void (*callback)(const char *alg_name, algorithm *alg));
+extern void foreach_algorithm(algorithms_map *map, void (*callback)(const char *alg_name, algorithm *alg)); // Ordre du code source
+extern void foreach_algorithm_bottom_up(algorithms_map *map, void (*callback)(const char *alg_name, algorithm *alg)); // Appelés d'abord
+extern int algorithms_count(const algorithms_map *map);
+// Tableau à libérer, dans l'ordre de l'un des deux parcours
+extern algorithm **get_algorithms(algorithms_map *map, int bottom_up, int *count);
 
 extern void print_algorithm(const algorithm *alg);
 
@@ -0,0 +1,217 @@
+#include "callgraph.h"
+
+#define CALLEES_BUF_INIT 2
+#define CALLEES_BUF_MUL 2
+#define NODES_BUF_INIT 8
+#define NODES_BUF_MUL 2
+
+
+typedef struct call_node call_node;
+
+struct call_node {
+    const char *name; // Interné
+    call_node **callees;
+    int callees_count;
+    int callees_size;
+    const char **callers;
+    int callers_count;
+    int callers_size;
+
+    // Algorithme de Tarjan
+    int index;          // Ordre de découverte, -1 si non visité
+    int lowlink;
+    int on_stack;
+    int next_callee;    // Prochain appelé à parcourir
+};
+
+struct call_graph {
+    hashtable *map;
+    call_node **nodes;  // Ordre d'ajout (ordre du code source)
+    int nodes_count;
+    int nodes_size;
+
+    int sorted;         // order à jour
+    const char **order;
+    call_node **stack;  // Nœuds des composantes pas encore terminées
+    int stack_count;
+    call_node **path;   // Chemin du parcours en profondeur en cours
+    int next_index;
+    int order_count;
+};
+
+
+call_graph *create_call_graph() {
+    call_graph *g = cralloc(sizeof *g);
+    g->map = hashtable_empty((cmpfunc) interned_cmp, (hashfunc) interned_hash);
+    if (g->map == NULL) {
+        ERROR("Could not allocate call graph\n");
+    }
+    g->nodes_size = NODES_BUF_INIT;
+    g->nodes = cralloc((size_t) g->nodes_size * sizeof *g->nodes);
+    g->nodes_count = 0;
+    g->sorted = 0;
+    g->order = NULL;
+    g->stack = NULL;
+    g->path = NULL;
+    return g;
+}
+
+void dispose_call_graph(call_graph **graph) {
+    if (*graph == NULL) return;
+    for (int i = 0; i < (*graph)->nodes_count; ++i) {
+        call_node *node = (*graph)->nodes[i];
+        free(node->callees);
+        free(node->callers);
+        free(node);
+    }
+    free((*graph)->nodes);
+    free((*graph)->order);
+    free((*graph)->stack);
+    free((*graph)->path);
+    hashtable_dispose(&(*graph)->map);
+    free(*graph);
+    *graph = NULL;
+}
+
+static call_node *get_node(call_graph *graph, const char *name) {
+    call_node *node = hashtable_search(graph->map, name);
+    if (node != NULL) {
+        return node;
+    }
+
+    node = cralloc(sizeof *node);
+    node->name = name;
+    node->callees_size = CALLEES_BUF_INIT;
+    node->callees = cralloc((size_t) node->callees_size * sizeof *node->callees);
+    node->callees_count = 0;
+    node->callers_size = CALLEES_BUF_INIT;
+    node->callers = cralloc((size_t) node->callers_size * sizeof *node->callers);
+    node->callers_count = 0;
+
+    if (graph->nodes_count == graph->nodes_size) {
+        graph->nodes_size *= NODES_BUF_MUL;
+        graph->nodes = realloc(graph->nodes, (size_t) graph->nodes_size * sizeof *graph->nodes);
+        if (graph->nodes == NULL) {
+            ERROR("Could not allocate call graph\n");
+        }
+    }
+    graph->nodes[graph->nodes_count++] = node;
+    hashtable_add(graph->map, node->name, node);
+    graph->sorted = 0;
+    return node;
+}
+
+void add_call_graph_node(call_graph *graph, const char *name) {
+    get_node(graph, name);
+}
+
+void add_call_edge(call_graph *graph, const char *caller, const char *callee) {
+    call_node *from = get_node(graph, caller);
+    call_node *to = get_node(graph, callee);
+    for (int i = 0; i < from->callees_count; ++i) {
+        if (from->callees[i] == to) return;
+    }
+
+    if (from->callees_count == from->callees_size) {
+        from->callees_size *= CALLEES_BUF_MUL;
+        from->callees = realloc(from->callees, (size_t) from->callees_size * sizeof *from->callees);
+        if (from->callees == NULL) {
+            ERROR("Could not allocate call graph\n");
+        }
+    }
+    from->callees[from->callees_count++] = to;
+
+    if (to->callers_count == to->callers_size) {
+        to->callers_size *= CALLEES_BUF_MUL;
+        to->callers = realloc(to->callers, (size_t) to->callers_size * sizeof *to->callers);
+        if (to->callers == NULL) {
+            ERROR("Could not allocate call graph\n");
+        }
+    }
+    to->callers[to->callers_count++] = from->name;
+    graph->sorted = 0;
+}
+
+static void visit_node(call_graph *graph, call_node *node) {
+    node->index = node->lowlink = graph->next_index++;
+    node->next_callee = 0;
+    graph->stack[graph->stack_count++] = node;
+    node->on_stack = 1;
+}
+
+// Parcours itératif : une longue chaîne d'appels ne remplit pas la pile C
+static void strong_connect(call_graph *graph, call_node *root) {
+    int depth = 0;
+    visit_node(graph, root);
+    graph->path[depth++] = root;
+
+    while (depth > 0) {
+        call_node *node = graph->path[depth - 1];
+        if (node->next_callee < node->callees_count) {
+            call_node *callee = node->callees[node->next_callee++];
+            if (callee->index == -1) {
+                visit_node(graph, callee);
+                graph->path[depth++] = callee;
+            } else if (callee->on_stack && callee->index < node->lowlink) {
+                node->lowlink = callee->index;
+            }
+            continue;
+        }
+
+        // node est la racine d'une composante, terminée après tous ses appelés
+        if (node->lowlink == node->index) {
+            call_node *member;
+            do {
+                member = graph->stack[--graph->stack_count];
+                member->on_stack = 0;
+                graph->order[graph->order_count++] = member->name;
+            } while (member != node);
+        }
+        depth--;
+        if (depth > 0 && node->lowlink < graph->path[depth - 1]->lowlink) {
+            graph->path[depth - 1]->lowlink = node->lowlink;
+        }
+    }
+}
+
+static void sort_call_graph(call_graph *graph) {
+    if (graph->sorted) return;
+
+    free(graph->order);
+    free(graph->stack);
+    free(graph->path);
+    graph->order = cralloc(((size_t) graph->nodes_count + 1) * sizeof *graph->order);
+    graph->stack = cralloc(((size_t) graph->nodes_count + 1) * sizeof *graph->stack);
+    graph->path = cralloc(((size_t) graph->nodes_count + 1) * sizeof *graph->path);
+    graph->stack_count = 0;
+    graph->next_index = 0;
+    graph->order_count = 0;
+
+    for (int i = 0; i < graph->nodes_count; ++i) {
+        graph->nodes[i]->index = -1;
+        graph->nodes[i]->on_stack = 0;
+    }
+    for (int i = 0; i < graph->nodes_count; ++i) {
+        if (graph->nodes[i]->index == -1) {
+            strong_connect(graph, graph->nodes[i]);
+        }
+    }
+    graph->order[graph->order_count] = NULL;
+    graph->sorted = 1;
+}
+
+const char **call_graph_order(call_graph *graph, int *count) {
+    sort_call_graph(graph);
+    *count = graph->order_count;
+    return graph->order;
+}
+
+const char **call_graph_callers(call_graph *graph, const char *name, int *count) {
+    call_node *node = hashtable_search(graph->map, name);
+    if (node == NULL) {
+        *count = 0;
+        return NULL;
+    }
+    *count = node->callers_count;
+    return node->callers;
+}
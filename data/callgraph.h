@@ -0,0 +1,21 @@
+#ifndef CALLGRAPH__H
+#define CALLGRAPH__H
+
+typedef struct call_graph call_graph;
+
+#include "hashtable.h"
+#include "utils.h"
+#include "intern.h"
+
+// Les noms d'algorithmes sont internés (intern) : comparés par pointeur
+extern call_graph *create_call_graph();
+extern void dispose_call_graph(call_graph **graph);
+extern void add_call_graph_node(call_graph *graph, const char *name);
+extern void add_call_edge(call_graph *graph, const char *caller, const char *callee);
+
+// Composantes fortement connexes en ordre topologique inverse : un algorithme
+//   vient après tous ceux qu'il appelle, sauf au sein d'une même composante
+extern const char **call_graph_order(call_graph *graph, int *count);
+extern const char **call_graph_callers(call_graph *graph, const char *name, int *count);
+
+#endif
@@ -1,7 +1,7 @@
 #include "variables.h"
 
 struct variable {
-    char *name;
+    const char *name; // Interné
     int position;
     variable_semantic semantic;
     value_type type;
@@ -12,7 +12,7 @@ struct variables_map {
     int params_count;
     int locals_count;
 
-    const char **param_names;
+    const char **param_names; // Internés
 };
 
 int params_count(const variables_map *map) {
@@ -25,7 +25,7 @@ int locals_count(const variables_map *map) {
 
 variables_map *create_variables_map() {
     variables_map *r = cralloc(sizeof *r);
-    r->map = hashtable_empty((cmpfunc) strcmp, (hashfunc) str_hashfun);
+    r->map = hashtable_empty((cmpfunc) interned_cmp, (hashfunc) interned_hash);
     if (r->map == NULL) {
         ERROR("Could not allocate variables map\n");
     }
@@ -36,6 +36,19 @@ variables_map *create_variables_map() {
     return r;
 }
 
+static void dispose_variable([[ maybe_unused ]] const char *var_name, variable *var) {
+    free(var);
+}
+
+void dispose_variables_map(variables_map **map) {
+    if (*map == NULL) return;
+    foreach_variable(*map, dispose_variable);
+    free((*map)->param_names);
+    hashtable_dispose(&(*map)->map);
+    free(*map);
+    *map = NULL;
+}
+
 variable *get_variable(const variables_map *map, const char *var_name) {
     variable *var = hashtable_search(map->map, var_name);
     if (var == NULL) {
@@ -51,8 +64,7 @@ int variable_exists(const variables_map *map, const char *var_name) {
 
 static variable *create_var(variables_map *map, const char *var_name, value_type var_type) {
     variable *var = cralloc(sizeof *var);
-    var->name = cralloc(strlen(var_name) + 1);
-    strcpy(var->name, var_name);
+    var->name = var_name;
     var->type = var_type;
 
     hashtable_add(map->map, var->name, var);
@@ -83,13 +95,46 @@ variable *create_parameter(variables_map *map, const char *var_name) {
     var->semantic = SEM_PARAM;
     var->position = map->params_count++;
     
-    const char *pname = mstrcpy(var_name);
-    map->param_names[map->params_count - 1] = pname;
+    map->param_names[map->params_count - 1] = var->name;
     map->param_names[map->params_count] = NULL;
 
     return var;
 }
 
+// Retire var de la liste des paramètres, les suivants prennent sa place
+static void unlink_parameter(variables_map *map, variable *var) {
+    if (var->semantic != SEM_PARAM) {
+        ERRORF("Cannot remove parameter, '%s' is not a parameter\n", var->name);
+    }
+
+    for (int i = var->position + 1; i < map->params_count; ++i) {
+        variable *next = get_variable(map, map->param_names[i]);
+        next->position--;
+        map->param_names[i - 1] = map->param_names[i];
+    }
+    map->params_count--;
+    map->param_names[map->params_count] = NULL;
+}
+
+void remove_parameter(variables_map *map, const char *var_name) {
+    variable *var = get_variable(map, var_name);
+    unlink_parameter(map, var);
+    hashtable_remove(map->map, var->name);
+    free(var);
+}
+
+variable *demote_parameter(variables_map *map, const char *var_name) {
+    variable *var = get_variable(map, var_name);
+    unlink_parameter(map, var);
+    var->semantic = SEM_LOCAL;
+    var->position = map->locals_count++;
+    return var;
+}
+
+int get_variable_id(const variables_map *map, const variable *var) {
+    return var->semantic == SEM_PARAM ? var->position : map->params_count + var->position;
+}
+
 const char *get_variable_name(const variable *var) {
     return var->name;
 }
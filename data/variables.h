@@ -16,20 +16,26 @@ typedef struct variables_map variables_map;
 #include "value_type.h"
 #include "hashtable.h"
 #include "utils.h"
+#include "intern.h"
 
 extern int params_count(const variables_map *map);
 extern int locals_count(const variables_map *map);
 
+// Les noms de variables sont internés (intern) : comparés par pointeur
 extern variables_map *create_variables_map();
+extern void dispose_variables_map(variables_map **map);
 extern variable *get_variable(const variables_map *map, const char *var_name);
 extern int variable_exists(const variables_map *map, const char *var_name);
 extern variable *create_local(variables_map *map, const char *var_name);
 extern variable *create_parameter(variables_map *map, const char *var_name);
+extern void remove_parameter(variables_map *map, const char *var_name); // Décale les suivants
+extern variable *demote_parameter(variables_map *map, const char *var_name); // Devient une locale, même variable
 
 extern const char *get_variable_name(const variable *var);
 extern value_type get_variable_type(const variable *var);
 extern variable_semantic get_variable_semantic(const variable *var);
 extern int get_variable_pos(const variable *var);
+extern int get_variable_id(const variables_map *map, const variable *var); // Dense : paramètres puis locales
 extern value_type unify_variable_type(variable *var, value_type new_type); // Crash si incohérent
 
 extern const char **get_all_param_names(const variables_map *map);
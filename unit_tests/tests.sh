@@ -4,6 +4,9 @@ codes_dir="./codes/"
 compiler_path="../compiler/algosipro"
 compiled_asipro_path="./test_compiled.asipro"
 compiled_sipro_path="./test_compiled.sipro"
+batch_list_path="./test_batch.list"
+fragments_dir="./test_fragments"
+generated_algo_path="./test_generated.algo"
 
 RESET='\033[0m'
 RED='\033[0;31m'
@@ -27,10 +30,11 @@ function test_cmd {
         fi
 }
 
-# compile [file_path] : Compile le fichier algo au chemin [file_path] en fichier
-# asipro et sipro (chemins: $compiled_asipro_path et $compiled_sipro_path)
+# compile [file_path] [compiler_args...] : Compile le fichier algo au chemin
+# [file_path] en fichier asipro et sipro (chemins: $compiled_asipro_path et
+# $compiled_sipro_path)
 function compile {
-    $compiler_path < $1 > $compiled_asipro_path
+    $compiler_path "${@:2}" $1 > $compiled_asipro_path
     if [ $? != 0 ]; then
             echo ""
             printf "\n${RED}${BOLD}An error occurred during file compilation${RESET}\n"
@@ -40,18 +44,151 @@ function compile {
     asipro $compiled_asipro_path $compiled_sipro_path 2> /dev/null
 }
 
-#  test [file_name] [expected_result] : compile et execute le fichier
-#    se trouvant au chemin $codes_dir[file_name].algo, et vérifie que le résultat
-#    renvoyé par l'execution est [expected_result].
+#  test [file_name] [expected_result] [compiler_args...] : compile et execute
+#    le fichier se trouvant au chemin $codes_dir[file_name].algo, et vérifie que
+#    le résultat renvoyé par l'execution est [expected_result].
 function test {
     echo ""
     echo "Compiling $1.algo"
-    compile "$codes_dir$1.algo"
+    compile "$codes_dir$1.algo" "${@:3}"
     echo "Testing $1.algo"
     test_cmd "sipro $compiled_sipro_path" $2
     printf "${GREEN}${BOLD}>>>\t${RESET}${GREEN}File $1.algo passed${RESET}\n"
 }
 
+#  test_jobs [file_name] : vérifie que le code produit pour le fichier
+#    $codes_dir[file_name].algo est identique avec un seul thread (-j 1) et
+#    avec plusieurs (-j 4).
+function test_jobs {
+    echo ""
+    echo "Compiling $1.algo with 1 and 4 threads"
+    compile "$codes_dir$1.algo" -j 1
+    mv $compiled_asipro_path $compiled_asipro_path.j1
+    compile "$codes_dir$1.algo" -j 4
+    if ! cmp -s $compiled_asipro_path $compiled_asipro_path.j1; then
+            printf "\n${RED}${BOLD}Output of $1.algo depends on the number of threads${RESET}\n"
+            rm -f $compiled_asipro_path.j1
+            exit 1
+    fi
+    rm -f $compiled_asipro_path.j1
+    printf "${GREEN}${BOLD}>>>\t${RESET}${GREEN}File $1.algo compiled identically on 1 and 4 threads${RESET}\n"
+}
+
+# split_algorithms [asipro_path] [dir] : découpe le code asipro en un fichier
+# par algorithme dans [dir], chaque ligne allant à l'algorithme de la
+# dernière étiquette algo__<nom>... rencontrée (fonction, tables de sauts)
+function split_algorithms {
+    rm -rf $2
+    mkdir -p $2
+    awk -v dir=$2 '
+        /^:/ { name = ""; if (index($0, ":algo__") == 1) { split(substr($0, 8), parts, "__"); name = parts[1] } }
+        name != "" { print > (dir "/" name) }
+    ' $1
+}
+
+#  test_stable [file_name] [variant_name] [changed_algorithms...] : compile
+#    les fichiers $codes_dir[file_name].algo et $codes_dir[variant_name].algo,
+#    qui diffèrent d'un algorithme, et vérifie que le code de chaque algorithme
+#    du premier, hors [changed_algorithms], est identique octet par octet.
+function test_stable {
+    echo ""
+    echo "Compiling $1.algo and $2.algo"
+    for args in "" "-o"; do
+        compile "$codes_dir$1.algo" $args
+        split_algorithms $compiled_asipro_path $fragments_dir/base
+        compile "$codes_dir$2.algo" $args
+        split_algorithms $compiled_asipro_path $fragments_dir/variant
+        for fragment in $fragments_dir/base/*; do
+            name=$(basename $fragment)
+            if [[ " ${*:3} " == *" $name "* ]]; then
+                    continue
+            fi
+            if ! cmp -s $fragment $fragments_dir/variant/$name; then
+                    printf "\n${RED}${BOLD}Code of algorithm $name differs between $1.algo and $2.algo${RESET}\n"
+                    echo "Arguments: $args"
+                    exit 1
+            fi
+        done
+    done
+    rm -rf $fragments_dir
+    printf "${GREEN}${BOLD}>>>\t${RESET}${GREEN}Files $1.algo and $2.algo passed${RESET}\n"
+}
+
+#  test_error [file_name] [expected_message] [compiler_args...] : vérifie que
+#    la compilation du fichier $codes_dir[file_name].algo échoue avec une
+#    erreur contenant [expected_message].
+function test_error {
+    echo ""
+    echo "Compiling $1.algo, expecting an error"
+    message=$($compiler_path "${@:3}" "$codes_dir$1.algo" 2>&1 > /dev/null)
+    if [ $? == 0 ]; then
+            printf "\n${RED}${BOLD}Compilation of $1.algo should have failed${RESET}\n"
+            exit 1
+    fi
+    if [[ "$message" != *"$2"* ]]; then
+            printf "\n${RED}${BOLD}Unexpected error for $1.algo${RESET}\n"
+            echo "Got: $message"
+            echo "Expected: $2"
+            exit 1
+    fi
+    printf "${GREEN}${BOLD}>>>\t${RESET}${GREEN}File $1.algo failed as expected${RESET}\n"
+}
+
+#  test_long_block [statements_count] : génère un algorithme de
+#    [statements_count] instructions à la suite et vérifie qu'il se compile
+#    avec une pile de 1 Mo, la profondeur de récursion des passes ne devant
+#    pas dépendre de la longueur d'un bloc. Le code produit, trop grand pour
+#    la mémoire de sipro, n'est pas exécuté.
+function test_long_block {
+    echo ""
+    echo "Compiling a block of $1 statements"
+    {
+        echo '\begin{algo}{long_block}{x}'
+        for ((i = 0; i < $1; i++)); do
+            echo '    \INCR{x}'
+        done
+        echo '    \RETURN{x}'
+        echo '\end{algo}'
+        echo '\CALL{long_block}{1}'
+    } > $generated_algo_path
+    for args in "" "-o"; do
+        (ulimit -s 1024; $compiler_path $args $generated_algo_path > $compiled_asipro_path)
+        if [ $? != 0 ]; then
+                printf "\n${RED}${BOLD}An error occurred during compilation of $1 statements${RESET}\n"
+                echo "Arguments: $args"
+                exit 1
+        fi
+    done
+    rm -f $generated_algo_path
+    printf "${GREEN}${BOLD}>>>\t${RESET}${GREEN}Block of $1 statements passed${RESET}\n"
+}
+
+#  test_batch [file_names...] : compile les fichiers $codes_dir[file_name].algo
+#    en une seule invocation, sur plusieurs threads (liste et arguments), et
+#    vérifie que chaque .asipro écrit à côté de son fichier est identique au
+#    code produit par la compilation de ce fichier seul.
+function test_batch {
+    echo ""
+    echo "Compiling $# files in one batch"
+    printf "$codes_dir%s.algo\n" "${@:2}" > $batch_list_path
+    $compiler_path -j 4 -l $batch_list_path "$codes_dir$1.algo"
+    if [ $? != 0 ]; then
+            echo ""
+            printf "\n${RED}${BOLD}An error occurred during batch compilation${RESET}\n"
+            exit 1
+    fi
+    for name in "$@"; do
+        $compiler_path "$codes_dir$name.algo" > $compiled_asipro_path
+        if ! cmp -s $compiled_asipro_path "$codes_dir$name.asipro"; then
+                printf "\n${RED}${BOLD}Batch output differs for $name.algo${RESET}\n"
+                exit 1
+        fi
+        rm -f "$codes_dir$name.asipro"
+    done
+    rm -f $batch_list_path
+    printf "${GREEN}${BOLD}>>>\t${RESET}${GREEN}Batch of $# files passed${RESET}\n"
+}
+
 # all_tests : Lance les tests unitaires
 function all_tests {
     printf "\n${GREEN}${BOLD}Starting tests here${RESET}\n"
@@ -67,6 +204,36 @@ function all_tests {
     test fibonacci 55
     test mutual_recursion 5460
     test expr_opt 0
+    test reassociation 55
+    test wrapped_comparisons 1111
+    test conditions 11011
+    test divisions 244
+    test effects 1030
+    test fibonacci_memo 17711 -m
+    test idioms 31982
+    test scalar_evolution 18044
+    test known_conditions 130
+    test word_ranges 1111
+    test jump_table -7455
+    test dead_arguments 720
+    test unreachable 41
+    test flat_blocks 137
+    test many_algorithms 25015 -j 4
+    test parallel_purity 205 -j 4
+    test stable_output 77
+    test stable_output_extra 82
+
+    test_jobs many_algorithms
+    test_jobs parallel_purity
+
+    test_error unresolved_types "Types could not be resolved in algorithm g"
+    test_error duplicate_algorithm "Cannot create algorithm, name 'f' is already used"
+
+    test_stable stable_output stable_output_extra main
+
+    test_long_block 100000
+
+    test_batch simple fibonacci mutual_recursion idioms jump_table dead_arguments flat_blocks
 
     printf "\n${GREEN}${BOLD}No error occured during tests${RESET}\n"
 }
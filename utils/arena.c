@@ -0,0 +1,108 @@
+#include "arena.h"
+
+#include <pthread.h>
+#include <stdalign.h>
+#include "utils.h"
+
+#define ARENA_BLOCK_SIZE 16384
+#define ARENA_ALIGN alignof(max_align_t)
+
+struct arena_block {
+    struct arena_block *next;
+    size_t size;
+    size_t used;
+    alignas(max_align_t) unsigned char data[];
+};
+
+struct arena {
+    struct arena_block *blocks;     // Bloc courant en tête
+    arena *children;
+    arena *next_sibling;
+    arena *parent;
+};
+
+// Les sous-arènes de deux algorithmes d'une même table peuvent être créées ou
+//   libérées en même temps par deux threads : seuls les liens sont partagés
+static pthread_mutex_t g_links_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+arena *arena_create(arena *parent) {
+    arena *a = cralloc(sizeof *a);
+    a->blocks = NULL;
+    a->children = NULL;
+    a->parent = parent;
+    a->next_sibling = NULL;
+    if (parent != NULL) {
+        pthread_mutex_lock(&g_links_lock);
+        a->next_sibling = parent->children;
+        parent->children = a;
+        pthread_mutex_unlock(&g_links_lock);
+    }
+    return a;
+}
+
+static struct arena_block *arena_new_block(arena *a, size_t min_size) {
+    size_t size = min_size > ARENA_BLOCK_SIZE ? min_size : ARENA_BLOCK_SIZE;
+    struct arena_block *block = cralloc(sizeof *block + size);
+    block->size = size;
+    block->used = 0;
+    block->next = a->blocks;
+    a->blocks = block;
+    return block;
+}
+
+void *arena_alloc_aligned(arena *a, size_t size, size_t align) {
+    struct arena_block *block = a->blocks;
+    size_t start = block == NULL ? 0 : (block->used + align - 1) & ~(align - 1);
+    if (block == NULL || block->size < start || block->size - start < size) {
+        block = arena_new_block(a, size);
+        start = 0;
+    }
+    void *result = block->data + start;
+    block->used = start + size;
+    return result;
+}
+
+void *arena_alloc(arena *a, size_t size) {
+    return arena_alloc_aligned(a, size, ARENA_ALIGN);
+}
+
+char *arena_strcpy(arena *a, const char *src) {
+    char *res = arena_alloc_aligned(a, strlen(src) + 1, 1);
+    strcpy(res, src);
+    return res;
+}
+
+static void arena_free(arena *a) {
+    arena *child = a->children;
+    while (child != NULL) {
+        arena *next = child->next_sibling;
+        arena_free(child);
+        child = next;
+    }
+
+    struct arena_block *block = a->blocks;
+    while (block != NULL) {
+        struct arena_block *next = block->next;
+        free(block);
+        block = next;
+    }
+    free(a);
+}
+
+void arena_dispose(arena **a) {
+    if (*a == NULL) return;
+
+    // Détache l'arène de son parent
+    if ((*a)->parent != NULL) {
+        pthread_mutex_lock(&g_links_lock);
+        arena **link = &(*a)->parent->children;
+        while (*link != *a) {
+            link = &(*link)->next_sibling;
+        }
+        *link = (*a)->next_sibling;
+        pthread_mutex_unlock(&g_links_lock);
+    }
+    arena_free(*a);
+    *a = NULL;
+}
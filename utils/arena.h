@@ -0,0 +1,16 @@
+#ifndef ARENA__H
+#define ARENA__H
+
+#include <stddef.h>
+
+// Allocation par incrément de pointeur dans de grands blocs, tout est libéré
+//   en une fois. Une sous-arène est libérée avec son arène parente.
+typedef struct arena arena;
+
+extern arena *arena_create(arena *parent); // parent NULL : arène racine
+extern void *arena_alloc(arena *a, size_t size);
+extern void *arena_alloc_aligned(arena *a, size_t size, size_t align); // align : puissance de deux
+extern char *arena_strcpy(arena *a, const char *src);
+extern void arena_dispose(arena **a); // Libère aussi les sous-arènes
+
+#endif
@@ -0,0 +1,47 @@
+#include "diagnostic.h"
+
+#include <stdarg.h>
+#include <stdlib.h>
+
+static _Thread_local jmp_buf *g_handler = NULL;
+static _Thread_local diagnostic *g_diag = NULL;
+
+error_handler set_error_handler(jmp_buf *handler, diagnostic *diag) {
+    error_handler previous = { g_handler, g_diag };
+    g_handler = handler;
+    g_diag = diag;
+    return previous;
+}
+
+void restore_error_handler(error_handler previous) {
+    g_handler = previous.handler;
+    g_diag = previous.diag;
+}
+
+void report_error(int line, const char *format, ...) {
+    diagnostic local;
+    diagnostic *diag = g_handler != NULL ? g_diag : &local;
+
+    va_list args;
+    va_start(args, format);
+    diag->line = line;
+    vsnprintf(diag->message, sizeof diag->message, format, args);
+    va_end(args);
+
+    if (g_handler != NULL) {
+        // Un seul retour par gestionnaire : les erreurs suivantes terminent
+        jmp_buf *handler = g_handler;
+        set_error_handler(NULL, NULL);
+        longjmp(*handler, 1);
+    }
+    print_diagnostic(stderr, diag);
+    exit(EXIT_FAILURE);
+}
+
+void print_diagnostic(FILE *stream, const diagnostic *diag) {
+    if (diag->line <= 0) {
+        fprintf(stream, RED "%s" RESET, diag->message);
+    } else {
+        fprintf(stream, RED BOLD "Line %d: " RESET RED "%s" RESET, diag->line, diag->message);
+    }
+}
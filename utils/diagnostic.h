@@ -0,0 +1,36 @@
+#ifndef DIAGNOSTIC__H
+#define DIAGNOSTIC__H
+
+#include <setjmp.h>
+#include <stdio.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[0;31m"
+#define BOLD    "\033[1m"
+
+#define DIAGNOSTIC_MESSAGE_SIZE 512
+
+// Erreur de compilation
+typedef struct {
+    int line;                                   // <= 0 : sans position dans le code
+    char message[DIAGNOSTIC_MESSAGE_SIZE];      // Tronqué si trop long
+} diagnostic;
+
+// Gestionnaire d'erreurs d'un thread
+typedef struct {
+    jmp_buf *handler;   // NULL : termine
+    diagnostic *diag;
+} error_handler;
+
+// Tant qu'un gestionnaire est installé dans le thread, une erreur remplit
+//   *diag et revient par longjmp(*handler, 1). Sinon elle est affichée sur
+//   la sortie d'erreur et termine le programme.
+// Renvoie le gestionnaire remplacé, à réinstaller une fois l'appel terminé
+//   (y compris après longjmp) pour ne pas perdre celui d'un appelant
+extern error_handler set_error_handler(jmp_buf *handler, diagnostic *diag);
+extern void restore_error_handler(error_handler previous);
+extern _Noreturn void report_error(int line, const char *format, ...);
+
+extern void print_diagnostic(FILE *stream, const diagnostic *diag);
+
+#endif
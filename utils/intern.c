@@ -0,0 +1,57 @@
+#include "intern.h"
+
+#include <pthread.h>
+#include "hashtable.h"
+#include "arena.h"
+#include "utils.h"
+
+struct interned {
+    size_t hash;
+    char str[];
+};
+
+static hashtable *g_interned = NULL;
+static arena *g_interned_arena = NULL;
+static pthread_mutex_t g_interned_lock = PTHREAD_MUTEX_INITIALIZER; // Table partagée par les threads
+
+const char *intern(const char *s) {
+    pthread_mutex_lock(&g_interned_lock);
+    if (g_interned == NULL) {
+        g_interned = hashtable_empty((cmpfunc) strcmp, (hashfunc) str_hashfun);
+        if (g_interned == NULL) {
+            pthread_mutex_unlock(&g_interned_lock);
+            ERROR("Could not allocate interned strings table\n");
+        }
+        g_interned_arena = arena_create(NULL);
+    }
+
+    const char *found = hashtable_search(g_interned, s);
+    if (found != NULL) {
+        pthread_mutex_unlock(&g_interned_lock);
+        return found;
+    }
+
+    size_t len = strlen(s);
+    struct interned *entry = arena_alloc(g_interned_arena, sizeof *entry + len + 1);
+    entry->hash = str_hashfun(s);
+    memcpy(entry->str, s, len + 1);
+    hashtable_add(g_interned, entry->str, entry->str);
+    pthread_mutex_unlock(&g_interned_lock);
+    return entry->str;
+}
+
+void dispose_interned(void) {
+    pthread_mutex_lock(&g_interned_lock);
+    hashtable_dispose(&g_interned);
+    arena_dispose(&g_interned_arena);
+    pthread_mutex_unlock(&g_interned_lock);
+}
+
+size_t interned_hash(const char *s) {
+    const struct interned *entry = (const struct interned *) (s - offsetof(struct interned, str));
+    return entry->hash;
+}
+
+int interned_cmp(const char *s1, const char *s2) {
+    return s1 != s2;
+}
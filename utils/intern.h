@@ -0,0 +1,20 @@
+#ifndef INTERN__H
+#define INTERN__H
+
+#include <stddef.h>
+
+// Table globale des identifiants : une seule copie de chaque nom, deux noms
+//   internés sont égaux si et seulement si leurs pointeurs le sont. Partagée
+//   par les compilations du processus, elle est conservée entre elles : sa
+//   taille est bornée par le nombre de noms distincts rencontrés
+extern const char *intern(const char *s);
+
+// Libère la table et tous les noms internés. À n'appeler qu'une fois toutes
+//   les compilations terminées : un appel suivant à intern la recrée
+extern void dispose_interned(void);
+
+// Pour les tables de hachage dont les clés sont internées
+extern size_t interned_hash(const char *s); // Précalculé par intern
+extern int interned_cmp(const char *s1, const char *s2);
+
+#endif
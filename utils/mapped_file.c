@@ -0,0 +1,49 @@
+#define _DEFAULT_SOURCE // MAP_ANONYMOUS
+
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+int map_file(const char *path, size_t padding, mapped_file *file) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return 0;
+    }
+
+    // Réserve la place du padding : au-delà de la dernière page du fichier,
+    //   la projection anonyme fournit des zéros, là où une projection du
+    //   fichier seul provoquerait un SIGBUS
+    size_t size = (size_t) st.st_size;
+    size_t length = size + padding;
+    char *data = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED) {
+        close(fd);
+        return 0;
+    }
+    // La fin de la dernière page du fichier est remplie de zéros par le noyau
+    if (size > 0 && mmap(data, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(data, length);
+        close(fd);
+        return 0;
+    }
+    close(fd);
+
+    file->data = data;
+    file->size = size;
+    file->length = length;
+    return 1;
+}
+
+void unmap_file(mapped_file *file) {
+    if (file->data == NULL) return;
+    munmap(file->data, file->length);
+    file->data = NULL;
+}
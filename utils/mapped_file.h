@@ -0,0 +1,17 @@
+#ifndef MAPPED_FILE__H
+#define MAPPED_FILE__H
+
+#include <stddef.h>
+
+// Fichier projeté en mémoire en lecture, privé et modifiable (copie à
+//   l'écriture), suivi de padding octets nuls
+typedef struct {
+    char *data;
+    size_t size;        // Taille du fichier, sans le padding
+    size_t length;      // Taille de la projection
+} mapped_file;
+
+extern int map_file(const char *path, size_t padding, mapped_file *file); // 0 si le fichier ne peut être lu
+extern void unmap_file(mapped_file *file);
+
+#endif
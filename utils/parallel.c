@@ -0,0 +1,103 @@
+#define _POSIX_C_SOURCE 200809L // sysconf
+
+#include "parallel.h"
+
+#include <pthread.h>
+#include <setjmp.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include "diagnostic.h"
+#include "utils.h"
+
+typedef struct {
+    int count;
+    void (*task)(int index, void *context);
+    void *context;
+    atomic_int next;            // Prochaine tâche à prendre par un thread
+    atomic_int first_failure;   // Indice de la première tâche en erreur, count sinon
+    diagnostic *errors;         // Une par tâche
+} task_pool;
+
+// Garde le plus petit indice en erreur
+static void record_failure(task_pool *pool, int index) {
+    int failure = atomic_load(&pool->first_failure);
+    while (index < failure && !atomic_compare_exchange_weak(&pool->first_failure, &failure, index)) {
+    }
+}
+
+// Les variables locales ne sont pas relues après longjmp : index, pool et
+//   previous ne changent pas entre setjmp et le retour
+static void run_task(task_pool *pool, int index) {
+    jmp_buf handler;
+    error_handler previous = set_error_handler(&handler, &pool->errors[index]);
+    if (setjmp(handler) != 0) {
+        restore_error_handler(previous);
+        record_failure(pool, index);
+        return;
+    }
+    pool->task(index, pool->context);
+    restore_error_handler(previous);
+}
+
+static void *pool_worker(void *arg) {
+    task_pool *pool = arg;
+    for (;;) {
+        int index = atomic_fetch_add(&pool->next, 1);
+        if (index >= pool->count) {
+            return NULL;
+        }
+        // Les tâches après une erreur ne s'exécuteraient pas dans l'ordre
+        if (index < atomic_load(&pool->first_failure)) {
+            run_task(pool, index);
+        }
+    }
+}
+
+void parallel_for(int count, int jobs, void (*task)(int index, void *context), void *context) {
+    if (jobs == 0) {
+        jobs = processors_count();
+    }
+    if (jobs > count) {
+        jobs = count;
+    }
+    if (jobs <= 1) {
+        for (int i = 0; i < count; ++i) {
+            task(i, context);
+        }
+        return;
+    }
+
+    task_pool pool = { .count = count, .task = task, .context = context };
+    atomic_init(&pool.next, 0);
+    atomic_init(&pool.first_failure, count);
+    pool.errors = cralloc((size_t) count * sizeof *pool.errors);
+
+    // Le thread appelant garde son propre gestionnaire d'erreurs : il attend
+    pthread_t *workers = cralloc((size_t) jobs * sizeof *workers);
+    int started = 0;
+    while (started < jobs && pthread_create(&workers[started], NULL, pool_worker, &pool) == 0) {
+        started++;
+    }
+    // Faute de threads, le thread appelant prend sa part des tâches : pool
+    //   reste en vie tant que les threads lancés s'en servent
+    if (started < jobs) {
+        pool_worker(&pool);
+    }
+    for (int i = 0; i < started; ++i) {
+        pthread_join(workers[i], NULL);
+    }
+    free(workers);
+
+    int failure = atomic_load(&pool.first_failure);
+    if (failure < count) {
+        diagnostic error = pool.errors[failure];
+        free(pool.errors);
+        report_error(error.line, "%s", error.message);
+    }
+    free(pool.errors);
+}
+
+int processors_count(void) {
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    return processors > 0 ? (int) processors : 1;
+}
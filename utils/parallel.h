@@ -0,0 +1,15 @@
+#ifndef PARALLEL__H
+#define PARALLEL__H
+
+// Exécute task(index, context) pour chaque index de 0 à count - 1 sur jobs
+//   threads (0 : un par processeur). Avec un seul thread, les tâches
+//   s'exécutent dans l'ordre, dans le thread appelant. Sinon, une erreur
+//   (report_error) dans une tâche est rattrapée, et celle de plus petit indice
+//   est signalée à nouveau dans le thread appelant une fois les threads
+//   terminés : l'erreur ne dépend pas de l'ordonnancement. Si des threads ne
+//   peuvent pas être créés, le thread appelant exécute aussi des tâches
+extern void parallel_for(int count, int jobs, void (*task)(int index, void *context), void *context);
+
+extern int processors_count(void);
+
+#endif
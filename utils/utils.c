@@ -11,8 +11,7 @@ size_t str_hashfun(const char *s) {
 void *cralloc(size_t size) {
     void *result = malloc(size);
     if (result == NULL) {
-        fprintf(stderr, "Could not allocate\n");
-        exit(EXIT_FAILURE);
+        ERROR("Could not allocate\n");
     }
     return result;
 }
@@ -32,6 +31,7 @@ const char *b_op_to_str(binary_operator_t operator) {
         case OP_AND: return "&&";
         case OP_OR: return "||";
         case OP_EQUAL: return "==";
+        case OP_NEQUAL: return "!=";
         case OP_SGT: return ">";
         case OP_EGT: return ">=";
         case OP_SLT: return "<";
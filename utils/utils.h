@@ -4,21 +4,14 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "diagnostic.h"
 #include "ast.h"
 
-#define RESET   "\033[0m"
-#define RED     "\033[0;31m"
-#define BOLD    "\033[1m"
-
-#define ERRORF(format, ...) fprintf(stderr, RED format RESET, __VA_ARGS__); exit(EXIT_FAILURE);
+// Rattrapées par le gestionnaire d'erreurs du thread s'il y en a un (voir diagnostic.h)
+#define ERRORF(format, ...) report_error(-1, format, __VA_ARGS__);
 #define ERROR(str) ERRORF("%s", str);
 
-#define ERRORAF(context_node, format, ...)                                                        \
-    if (get_line(context_node) <= 0) {                                                            \
-        fprintf(stderr, RED format RESET, __VA_ARGS__); exit(EXIT_FAILURE);                       \
-    } else {                                                                                      \
-        fprintf(stderr, RED BOLD "Line %d: " RESET RED format RESET, get_line(context_node), __VA_ARGS__); exit(EXIT_FAILURE);  \
-    }                                                                                             \
+#define ERRORAF(context_node, format, ...) report_error(get_line(context_node), format, __VA_ARGS__);
 
 #define ERRORA(context_node, str) ERRORAF(context_node, "%s", str);
 